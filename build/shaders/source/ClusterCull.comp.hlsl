@@ -0,0 +1,87 @@
+struct PointLight
+{
+    float3 Position;
+    float Radius;
+    float3 Color;
+    float Intensity;
+};
+
+StructuredBuffer<PointLight> Lights : register(t0, space0);
+RWStructuredBuffer<uint> ClusterItems : register(u0, space1);
+RWStructuredBuffer<uint> Overflow : register(u1, space1); // clusters past Grid.w lights, lights they dropped
+
+cbuffer ClusterUniforms : register(b0, space2)
+{
+    float4x4 View;
+    float NearPlane;
+    float FarPlane;
+    float TanHalfFov;
+    float Aspect;
+    uint4 Grid; // clusters along x, y, z & max lights per cluster
+    float2 ScreenSize;
+    uint LightCount;
+};
+
+#define BATCH_SIZE 64
+
+// view space position & radius of the lights every thread of the group tests next
+groupshared float4 SharedLights[BATCH_SIZE];
+
+// One thread per cluster. Each cluster stores its light count followed by up to Grid.w light indices,
+// lights past that are dropped & counted in Overflow.
+[numthreads(BATCH_SIZE, 1, 1)]
+void main(uint3 GlobalID : SV_DispatchThreadID, uint3 LocalID : SV_GroupThreadID)
+{
+    uint cluster_count = Grid.x * Grid.y * Grid.z;
+    uint cluster = GlobalID.x;
+    uint3 c = uint3(cluster % Grid.x, (cluster / Grid.x) % Grid.y, cluster / (Grid.x * Grid.y));
+
+    // exponential depth slices, tiles counted from the top left of the screen
+    float near_depth = NearPlane * pow(FarPlane / NearPlane, (float)c.z / Grid.z);
+    float far_depth = NearPlane * pow(FarPlane / NearPlane, (float)(c.z + 1) / Grid.z);
+    float2 scale = float2(TanHalfFov * Aspect, TanHalfFov);
+    float2 a = float2(-1.0f + 2.0f * c.x / Grid.x, 1.0f - 2.0f * (c.y + 1) / Grid.y) * scale;
+    float2 b = float2(-1.0f + 2.0f * (c.x + 1) / Grid.x, 1.0f - 2.0f * c.y / Grid.y) * scale;
+    float3 box_min = float3(min(min(a * near_depth, a * far_depth), min(b * near_depth, b * far_depth)), -far_depth);
+    float3 box_max = float3(max(max(a * near_depth, a * far_depth), max(b * near_depth, b * far_depth)), -near_depth);
+
+    uint count = 0;
+    for (uint batch = 0; batch < LightCount; batch += BATCH_SIZE)
+    {
+        uint index = batch + LocalID.x;
+        if (index < LightCount)
+        {
+            PointLight light = Lights[index];
+            SharedLights[LocalID.x] = float4(mul(View, float4(light.Position, 1.0f)).xyz, light.Radius);
+        }
+        GroupMemoryBarrierWithGroupSync();
+
+        uint batch_size = min(BATCH_SIZE, LightCount - batch);
+        if (cluster < cluster_count)
+        {
+            for (uint i = 0; i < batch_size; ++i)
+            {
+                float4 light = SharedLights[i];
+                float3 offset = clamp(light.xyz, box_min, box_max) - light.xyz;
+                if (dot(offset, offset) <= light.w * light.w)
+                {
+                    if (count < Grid.w)
+                    {
+                        ClusterItems[cluster * (Grid.w + 1) + 1 + count] = batch + i;
+                    }
+                    ++count;
+                }
+            }
+        }
+        GroupMemoryBarrierWithGroupSync();
+    }
+    if (cluster < cluster_count)
+    {
+        ClusterItems[cluster * (Grid.w + 1)] = min(count, Grid.w);
+        if (count > Grid.w)
+        {
+            InterlockedAdd(Overflow[0], 1);
+            InterlockedAdd(Overflow[1], count - Grid.w);
+        }
+    }
+}
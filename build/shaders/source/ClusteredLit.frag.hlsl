@@ -0,0 +1,54 @@
+struct PointLight
+{
+    float3 Position;
+    float Radius;
+    float3 Color;
+    float Intensity;
+};
+
+StructuredBuffer<PointLight> Lights : register(t0, space2);
+StructuredBuffer<uint> ClusterItems : register(t1, space2);
+
+cbuffer ClusterUniforms : register(b0, space3)
+{
+    float4x4 View;
+    float NearPlane;
+    float FarPlane;
+    float TanHalfFov;
+    float Aspect;
+    uint4 Grid; // clusters along x, y, z & max lights per cluster
+    float2 ScreenSize;
+    uint LightCount;
+};
+
+float4 main(float4 Color : TEXCOORD0, float3 WorldPosition : TEXCOORD1, float4 Position : SV_Position) : SV_Target0
+{
+    float3 view_pos = mul(View, float4(WorldPosition, 1.0f)).xyz;
+    float view_depth = -view_pos.z;
+
+    // flat normal from the screen space derivatives, turned towards the camera
+    float3 normal = normalize(cross(ddy(view_pos), ddx(view_pos)));
+    if (dot(normal, -view_pos) < 0.0f)
+    {
+        normal = -normal;
+    }
+
+    // only the lights the cull pass assigned to this fragment's cluster
+    uint3 cluster;
+    cluster.xy = min(uint2(Position.xy / ScreenSize * Grid.xy), Grid.xy - 1);
+    cluster.z = min(uint(max(log(view_depth / NearPlane) / log(FarPlane / NearPlane) * Grid.z, 0.0f)), Grid.z - 1);
+    uint base = ((cluster.z * Grid.y + cluster.y) * Grid.x + cluster.x) * (Grid.w + 1);
+    uint count = ClusterItems[base];
+
+    float3 lighting = 0.15f;
+    for (uint i = 0; i < count; ++i)
+    {
+        PointLight light = Lights[ClusterItems[base + 1 + i]];
+        float3 to_light = mul(View, float4(light.Position, 1.0f)).xyz - view_pos;
+        float distance = length(to_light);
+        float falloff = saturate(1.0f - (distance * distance) / (light.Radius * light.Radius));
+        lighting += light.Color * light.Intensity * falloff * falloff * saturate(dot(normal, to_light / distance));
+    }
+
+    return float4(Color.rgb * lighting, Color.a);
+}
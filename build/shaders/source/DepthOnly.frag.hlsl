@@ -0,0 +1,4 @@
+// depth pre-pass: no color targets, the rasterizer writes depth on its own
+void main()
+{
+}
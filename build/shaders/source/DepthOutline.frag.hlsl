@@ -4,6 +4,19 @@ SamplerState ColorSampler : register(s0, space2);
 Texture2D DepthTexture : register(t1, space2);
 SamplerState DepthSampler : register(s1, space2);
 
+cbuffer DepthUniforms : register(b0, space3)
+{
+    float NearPlane;
+    float FarPlane;
+};
+
+// Reverse-Z depth (1 at the near plane, 0 at the far plane) to view distance over the far plane
+float LinearDepth(float2 TexCoord)
+{
+    float depth = DepthTexture.Sample(DepthSampler, TexCoord).r;
+    return NearPlane / (NearPlane + depth * (FarPlane - NearPlane));
+}
+
 // Gets the difference between a depth value and adjacent depth pixels
 // This is used to detect "edges", where the depth falls off.
 float GetDifference(float depth, float2 TexCoord, float distance)
@@ -12,17 +25,17 @@ float GetDifference(float depth, float2 TexCoord, float distance)
     DepthTexture.GetDimensions(w, h);
     
     return
-        max(DepthTexture.Sample(DepthSampler, TexCoord + float2(1.0 / w, 0) * distance).r - depth,
-        max(DepthTexture.Sample(DepthSampler, TexCoord + float2(-1.0 / w, 0) * distance).r - depth,
-        max(DepthTexture.Sample(DepthSampler, TexCoord + float2(0, 1.0 / h) * distance).r - depth,
-        DepthTexture.Sample(DepthSampler, TexCoord + float2(0, -1.0 / h) * distance).r - depth)));
+        max(LinearDepth(TexCoord + float2(1.0 / w, 0) * distance) - depth,
+        max(LinearDepth(TexCoord + float2(-1.0 / w, 0) * distance) - depth,
+        max(LinearDepth(TexCoord + float2(0, 1.0 / h) * distance) - depth,
+        LinearDepth(TexCoord + float2(0, -1.0 / h) * distance) - depth)));
 }
 
 float4 main(float2 TexCoord : TEXCOORD0) : SV_Target0
 {
     // get our color & depth value
     float4 color = ColorTexture.Sample(ColorSampler, TexCoord);
-    float depth = DepthTexture.Sample(DepthSampler, TexCoord).r;
+    float depth = LinearDepth(TexCoord);
 
     // get the difference between the edges at 1px and 2px away
     float edge = step(0.2, GetDifference(depth, TexCoord, 1.0f));
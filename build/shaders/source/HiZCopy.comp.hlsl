@@ -0,0 +1,41 @@
+Texture2D<float> Source : register(t0, space0);
+SamplerState SourceSampler : register(s0, space0);
+RWTexture2D<float> Destination : register(u0, space1);
+RWStructuredBuffer<uint> Covered : register(u1, space1);
+
+cbuffer HiZUniforms : register(b0, space2)
+{
+    uint2 SourceSize;
+    uint2 DestinationSize;
+};
+
+groupshared uint GroupCovered;
+
+// Copies the scene depth into level 0 of the Hi-Z chain and counts the pixels something was drawn to.
+[numthreads(8, 8, 1)]
+void main(uint3 GlobalID : SV_DispatchThreadID, uint GroupIndex : SV_GroupIndex)
+{
+    if (GroupIndex == 0)
+    {
+        GroupCovered = 0;
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    if (all(GlobalID.xy < DestinationSize))
+    {
+        float depth = Source.SampleLevel(SourceSampler, (float2(GlobalID.xy) + 0.5f) / SourceSize, 0);
+        Destination[GlobalID.xy] = depth;
+        // reverse-Z clears to 0, anything else was drawn
+        if (depth > 0.0f)
+        {
+            InterlockedAdd(GroupCovered, 1);
+        }
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    // one global atomic per group
+    if (GroupIndex == 0 && GroupCovered > 0)
+    {
+        InterlockedAdd(Covered[0], GroupCovered);
+    }
+}
@@ -0,0 +1,32 @@
+Texture2D<float> Source : register(t0, space0);
+SamplerState SourceSampler : register(s0, space0);
+RWTexture2D<float> Destination : register(u0, space1);
+
+cbuffer HiZUniforms : register(b0, space2)
+{
+    uint2 SourceSize;
+    uint2 DestinationSize;
+};
+
+// Each texel keeps the farthest depth of the source texels it covers, the smallest value with reverse-Z.
+// Odd source sizes don't halve evenly, so a texel covers 2 or 3 source texels along that axis.
+[numthreads(8, 8, 1)]
+void main(uint3 GlobalID : SV_DispatchThreadID)
+{
+    if (any(GlobalID.xy >= DestinationSize))
+    {
+        return;
+    }
+    uint2 first = GlobalID.xy * SourceSize / DestinationSize;
+    uint2 last = max((GlobalID.xy + 1) * SourceSize / DestinationSize, first + 1);
+
+    float depth = 1.0f;
+    for (uint y = first.y; y < last.y; ++y)
+    {
+        for (uint x = first.x; x < last.x; ++x)
+        {
+            depth = min(depth, Source.SampleLevel(SourceSampler, (float2(x, y) + 0.5f) / SourceSize, 0));
+        }
+    }
+    Destination[GlobalID.xy] = depth;
+}
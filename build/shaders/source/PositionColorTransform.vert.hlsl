@@ -12,6 +12,7 @@ struct Input
 struct Output
 {
     float4 Color : TEXCOORD0;
+    float3 WorldPosition : TEXCOORD1;
     float4 Position : SV_Position;
 };
 
@@ -19,6 +20,7 @@ Output main(Input input)
 {
     Output output;
     output.Color = input.Color;
+    output.WorldPosition = input.Position;
     output.Position = mul(transform, float4(input.Position, 1.0f));
     return output;
 }
@@ -19,5 +19,6 @@ Output main(float3 inTexCoord : TEXCOORD0)
 	Output output;
 	output.TexCoord = inTexCoord;
 	output.Position = mul(MatrixTransform, float4(inTexCoord, 1.0));
+	output.Position.z = 0.0; // far plane under reverse-Z, only passes where nothing was drawn
 	return output;
 }
@@ -0,0 +1,27 @@
+cbuffer UBO : register(b0, space1)
+{
+    float4x4 transform : packoffset(c0);
+};
+
+struct Input
+{
+    uint4 Position : TEXCOORD0; // chunk local corner, w is the face
+    float4 Color : TEXCOORD1;
+    float4 Origin : TEXCOORD2; // per instance, world position of the chunk's corner
+};
+
+struct Output
+{
+    float4 Color : TEXCOORD0;
+    float3 WorldPosition : TEXCOORD1;
+    float4 Position : SV_Position;
+};
+
+Output main(Input input)
+{
+    Output output;
+    output.Color = input.Color;
+    output.WorldPosition = float3(input.Position.xyz) + input.Origin.xyz;
+    output.Position = mul(transform, float4(output.WorldPosition, 1.0f));
+    return output;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <vector>
+#include <SDL3/SDL_gpu.h>
+
+#include "Context.hpp"
+#include "Math.hpp"
+#include "ShaderReloader.hpp"
+
+struct PointLight {
+	float position[3]; // world space
+	float radius;
+	float color[3];
+	float intensity;
+};
+
+// matches the ClusterUniforms cbuffer of ClusterCull.comp & ClusteredLit.frag
+struct ClusterUniforms {
+	Matrix4x4 view;
+	float near_far[2];
+	float tan_half_fov, aspect;
+	Uint32 grid[4]; // clusters along x, y, z & max lights per cluster
+	float screen_size[2];
+	Uint32 light_count;
+	float padding;
+};
+
+// matches the Overflow buffer of ClusterCull.comp
+struct ClusterOverflow {
+	Uint32 clusters; // clusters that touched more than MAX_LIGHTS_PER_CLUSTER lights
+	Uint32 lights; // lights those clusters dropped
+};
+
+// Splits the view frustum into GRID_X * GRID_Y screen tiles and GRID_Z exponential
+// depth slices. A compute pass assigns lights to the clusters they touch, lit
+// fragment shaders then only evaluate the lights of their own cluster.
+class ClusteredLighting {
+	public:
+		static constexpr Uint32 GRID_X { 16 }, GRID_Y { 9 }, GRID_Z { 24 };
+		static constexpr Uint32 MAX_LIGHTS { 4096 };
+		static constexpr Uint32 MAX_LIGHTS_PER_CLUSTER { 1023 }; // + 1 slot for the count, scatterLights(MAX_LIGHTS) peaks around 510
+		ClusteredLighting();
+		~ClusteredLighting();
+		void setLights(const PointLight *lights, const Uint32 &count);
+		void scatterLights(const Uint32 &count, Uint64 seed); // random lights over the scene, for testing
+		Uint32 lightCount() const { return static_cast<Uint32>(m_lights.size()); }
+		ClusterUniforms uniforms(const Matrix4x4 &view, const float &fov, const float &aspect, const float near_far[2]) const;
+		void cull(SDL_GPUCommandBuffer *cmdbuf, const ClusterUniforms &uniforms); // outside of any pass
+		void bind(SDL_GPURenderPass *render_pass); // fragment storage buffers 0 & 1, after binding a lit pipeline
+		ClusterOverflow overflow() const; // of the last cull, only valid once the GPU has finished it
+		void watchShaders(ShaderReloader &reloader); // hot reload the cull pipeline
+	private:
+		std::vector<PointLight> m_lights;
+		bool m_dirty { true };
+		SDL_GPUComputePipeline *m_cull_pipeline { nullptr };
+		SDL_GPUBuffer *m_light_buffer { nullptr }, *m_cluster_buffer { nullptr }, *m_overflow_buffer { nullptr };
+		SDL_GPUTransferBuffer *m_transfer_buffer { nullptr }, *m_overflow_zero { nullptr }, *m_overflow_readback { nullptr };
+		static constexpr Uint32 CULL_THREADS { 64 };
+		static const SDL_ShaderCross_ComputePipelineMetadata CULL_METADATA;
+};
@@ -8,7 +8,7 @@ struct ContextData {
 		Uint32 width, height;
 		SDL_GPUDevice *gpu;
 		SDL_GPUShaderFormat shader_format;
-		const char *exe_path, *shaders_path;
+		const char *exe_path, *shaders_path, *textures_path;
 		Vector3 camera_pos {0, 0, 4};
 		float delta_time { };
 };
@@ -0,0 +1,58 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <SDL3/SDL_stdinc.h>
+
+// Bump allocator. Memory is only reclaimed by reset(), nothing is destructed.
+// Running past the block chains a heap allocated overflow block, reset() folds
+// those into one larger block so a steady workload stops touching the heap.
+class alignas(64) LinearArena {
+	public:
+		LinearArena() { }
+		~LinearArena();
+		LinearArena(const LinearArena &obj) = delete;
+		LinearArena& operator = (const LinearArena &obj) = delete;
+		void reserve(const size_t &t_capacity);
+		void* allocate(const size_t &size, const size_t &align = alignof(std::max_align_t));
+		template<typename T> T* create(const size_t &count = 1) {
+			static_assert(std::is_trivially_destructible_v<T>, "LinearArena never runs destructors");
+			T *result { static_cast<T*>(allocate(sizeof(T) * count, alignof(T))) };
+			for (size_t i = 0; result != nullptr && i < count; ++i) {
+				new (result + i) T {};
+			}
+			return result;
+		}
+		void reset();
+		size_t used() const { return m_used + m_overflow_used; }
+		size_t capacity() const { return m_capacity; }
+		Uint64 heapAllocations() const { return m_heap_allocations; }
+	private:
+		struct Overflow {
+			Overflow *next;
+			size_t size, used;
+		};
+		Uint8 *m_data { nullptr };
+		size_t m_capacity { }, m_used { }, m_overflow_used { };
+		Overflow *m_overflow { nullptr };
+		Uint64 m_heap_allocations { };
+};
+
+// Frame scoped allocations: one sub-arena per thread, all reset together at the frame boundary.
+// Slot 0 is the render thread. Slots 1.. are for jobs the render thread forks and joins
+// within a frame, one slot per job thread. Long-lived workers that run across frames
+// (TextureStreamer, VoxelWorld, ShaderReloader) must not use them, as reset() would
+// reclaim their memory while they still hold it.
+class FrameArena {
+	public:
+		static constexpr int MAX_THREADS { 8 };
+		FrameArena(const size_t &t_capacity_per_thread);
+		LinearArena& local(const int &thread_index = 0) { return m_arenas.at(thread_index); }
+		void reset(); // no thread may be allocating
+		Uint64 heapAllocations() const;
+	private:
+		std::array<LinearArena, MAX_THREADS> m_arenas;
+		Uint64 m_frame { }, m_last_heap_allocations { };
+		static constexpr Uint64 WARM_UP_FRAMES { 120 };
+};
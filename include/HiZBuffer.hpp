@@ -0,0 +1,67 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <SDL3/SDL_gpu.h>
+
+#include "Context.hpp"
+#include "Math.hpp"
+#include "ShaderReloader.hpp"
+
+// matches the HiZUniforms cbuffer of HiZCopy.comp & HiZReduce.comp
+struct HiZUniforms {
+	Uint32 source_size[2];
+	Uint32 destination_size[2];
+};
+
+// Hierarchical depth built from the scene depth after the world pass. Level 0 is a
+// copy of the depth, every further level keeps the farthest depth of the texels
+// under it. The coarse levels are read back so object bounds can be occlusion
+// tested on the CPU before their draws are recorded. Readbacks cycle through a few
+// slots, so the fetched depth is usually last frame's. Boxes are projected as seen from
+// where it was drawn, widened & pulled nearer by how far the camera has moved since.
+class HiZBuffer {
+	public:
+		static constexpr Uint32 READBACK_WIDTH { 256 }; // levels at most this wide are read back
+		static constexpr size_t READBACK_SLOTS { 3 }; // covers the frames SDL keeps in flight, so a build rarely has to be skipped
+		HiZBuffer();
+		~HiZBuffer();
+		void fetch(const Vector3 &camera_pos); // once per frame, picks up a finished readback
+		void build(SDL_GPUCommandBuffer *cmdbuf, SDL_GPUTexture *depth, const Matrix4x4 &view_proj, const float near_far[2], const Vector3 &camera_pos); // outside of any pass, a no-op while every readback slot is in flight
+		void submit(SDL_GPUCommandBuffer *cmdbuf); // in place of SDL_SubmitGPUCommandBuffer, fenced when it carries a readback
+		bool occluded(const Vector3 &box_min, const Vector3 &box_max); // world space bounds, counted in the report
+		void report(const bool &depth_prepass);
+		void watchShaders(ShaderReloader &reloader); // hot reload the build pipelines
+	private:
+		struct Readback {
+			SDL_GPUTransferBuffer *buffer { nullptr };
+			SDL_GPUFence *fence { nullptr };
+			Matrix4x4 view_proj { }; // what the depth in it was drawn with
+			float near_far[2] { };
+			Vector3 camera_pos { }; // and from where
+			Uint64 frame { };
+		};
+		std::vector<SDL_GPUTexture*> m_levels; // one texture per level, a pass can't sample the texture it writes
+		std::vector<std::array<Uint32, 2>> m_sizes;
+		size_t m_readback_level { };
+		SDL_GPUComputePipeline *m_copy_pipeline { nullptr }, *m_reduce_pipeline { nullptr };
+		SDL_GPUSampler *m_sampler { nullptr };
+		SDL_GPUBuffer *m_covered { nullptr }; // pixels drawn to this frame
+		SDL_GPUTransferBuffer *m_zero { nullptr };
+		std::array<Readback, READBACK_SLOTS> m_readbacks { };
+		Readback *m_recorded { nullptr }; // slot to fence on submit
+		Matrix4x4 m_view_proj { }; // the fetched depth's, as in its slot
+		float m_near_far[2] { }, m_scale[2] { }; // and the projection's x & y scale
+		Vector3 m_camera_pos { };
+		Uint64 m_fetched_frame { };
+		float m_drift { }; // camera movement since the fetched depth was drawn
+		std::vector<float> m_depth; // levels from m_readback_level down, one after the other
+		std::vector<Uint32> m_offsets; // first texel of each read back level in m_depth
+		bool m_valid { false };
+		Uint32 m_covered_pixels { };
+		Uint64 m_tested { }, m_rejected { }, m_frames { }, m_fetched_frames { }, m_age { };
+		double m_drift_sum { };
+		Uint64 m_report_ns { }, m_reported_tested { }, m_reported_rejected { }, m_reported_frames { }, m_reported_fetched_frames { }, m_reported_age { };
+		double m_reported_drift_sum { };
+		static constexpr Uint32 BUILD_THREADS { 8 };
+		static const SDL_ShaderCross_ComputePipelineMetadata COPY_METADATA, REDUCE_METADATA;
+};
@@ -2,7 +2,13 @@
 #include <SDL3_shadercross/SDL_shadercross.h>
 
 #include "Buffer.hpp"
+#include "ClusteredLighting.hpp"
+#include "FrameArena.hpp"
+#include "HiZBuffer.hpp"
 #include "Math.hpp"
+#include "ShaderReloader.hpp"
+#include "TextureStreamer.hpp"
+#include "VoxelWorld.hpp"
 #include "SDL3/SDL_gpu.h"
 
 struct PositionColorVertex {
@@ -19,32 +25,60 @@ struct PositionTextureVertex {
 	float u, v;
 };
 
+// per-frame values shared by every pass, lives in the frame arena
+struct FrameUniforms {
+	Matrix4x4 view_proj, sky_view_proj;
+	float near_far[2];
+	ClusterUniforms lighting;
+};
+
 Matrix4x4 CreateProjection(const float &fov, const float &aspect, const float &near, const float &far);
 Matrix4x4 CreateView(const Vector3 &camera_pos, const Vector3 &camera_target, const Vector3 &camera_up);
 SDL_GPUShader* LoadShader(const ContextData &ctx, const char *filename, const Uint32 &num_samplers, const Uint32 &num_uniform_buffers, const Uint32 &num_storage_buffers, const Uint32 &num_storage_textures);
+SDL_GPUComputePipeline* LoadComputePipeline(const ContextData &ctx, const char *filename, const SDL_ShaderCross_ComputePipelineMetadata &metadata);
 
 class SceneMaterial {
 	public:
 		SceneMaterial();
 		~SceneMaterial();
 		void draw();
+		void refresh() { m_reloader.requestAll(); }
+		void finish(); // block until the GPU has drained all submitted work
 		VertexBuffer<PositionColorVertex>* worldVertBuffer() { return &m_world_v; }
 		IndexBuffer* worldIndexBuffer() { return &m_world_i; }
+		FrameArena* frameArena() { return &m_frame_arena; }
+		ClusteredLighting* lighting() { return &m_lighting; }
+		bool depthPrepass() const { return m_depth_prepass; }
+		void setDepthPrepass(const bool &enabled) { m_depth_prepass = enabled; }
 	private:
 		int init();
 		bool loadShaders(const ContextData &ctx);
-		bool createWorldPipeline(const ContextData &ctx);
-		bool createScreenPipeline(const ContextData &ctx);
+		bool createPipelines(const ContextData &ctx);
+		SDL_GPUGraphicsPipeline* createWorldPipeline(const ContextData &ctx, SDL_GPUShader *vert, SDL_GPUShader *frag, const bool &depth_only) const;
+		SDL_GPUGraphicsPipeline* createScreenPipeline(const ContextData &ctx, SDL_GPUShader *vert, SDL_GPUShader *frag) const;
+		SDL_GPUGraphicsPipeline* createSkyboxPipeline(const ContextData &ctx, SDL_GPUShader *vert, SDL_GPUShader *frag) const;
+		SDL_GPUGraphicsPipeline* createVoxelPipeline(const ContextData &ctx, SDL_GPUShader *vert, SDL_GPUShader *frag, const bool &depth_only) const;
 		bool createColorTexture(const ContextData &ctx);
 		bool createDepthTexture(const ContextData &ctx);
 		bool createSampler(const ContextData &ctx);
 		float m_time {};
-		std::array<SDL_GPUShader*, 4> m_shaders;
+		std::array<SDL_GPUShader*, 12> m_shaders;
 		VertexBuffer<PositionColorVertex> m_world_v;
 		IndexBuffer m_world_i;
 		VertexBuffer<PositionTextureVertex> m_screen_v;
 		IndexBuffer m_screen_i;
-		SDL_GPUGraphicsPipeline *m_world_pipeline, *m_screen_pipeline;
+		VertexBuffer<PositionVertex> m_skybox_v;
+		IndexBuffer m_skybox_i;
+		SDL_GPUGraphicsPipeline *m_world_pipeline, *m_screen_pipeline, *m_skybox_pipeline, *m_voxel_pipeline;
+		SDL_GPUGraphicsPipeline *m_world_depth_pipeline, *m_voxel_depth_pipeline;
 		SDL_GPUTexture *m_scene_color, *m_scene_depth;
-		SDL_GPUSampler *m_sampler;
+		SDL_GPUSampler *m_sampler, *m_skybox_sampler;
+		TextureStreamer m_textures;
+		TextureHandle m_skybox { INVALID_TEXTURE };
+		FrameArena m_frame_arena;
+		VoxelWorld m_voxels;
+		ClusteredLighting m_lighting;
+		HiZBuffer m_hiz;
+		bool m_depth_prepass { true };
+		ShaderReloader m_reloader; // last, so its thread stops before anything else is torn down
 };
@@ -0,0 +1,72 @@
+#pragma once
+#include <functional>
+#include <vector>
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_filesystem.h>
+#include <SDL3/SDL_gpu.h>
+#include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_thread.h>
+#include <SDL3_shadercross/SDL_shadercross.h>
+
+#include "Context.hpp"
+
+struct ShaderDesc {
+	const char *filename;
+	Uint32 num_samplers, num_uniform_buffers, num_storage_buffers, num_storage_textures;
+};
+
+// builds a pipeline from already compiled shaders, must not touch render thread state
+using PipelineBuilder = std::function<SDL_GPUGraphicsPipeline*(const ContextData &ctx, SDL_GPUShader *vert, SDL_GPUShader *frag)>;
+
+// Watches shader sources and rebuilds the graphics & compute pipelines that use them on a background thread.
+// Rebuilt pipelines are only swapped in by swap(), the old one keeps rendering until then.
+class ShaderReloader {
+	public:
+		ShaderReloader() { }
+		~ShaderReloader();
+		void watch(SDL_GPUGraphicsPipeline **pipeline, const ShaderDesc &vert, const ShaderDesc &frag, PipelineBuilder builder); // before start()
+		void watch(SDL_GPUComputePipeline **pipeline, const char *filename, const SDL_ShaderCross_ComputePipelineMetadata &metadata); // before start()
+		bool start();
+		void requestAll(); // rebuild every pipeline regardless of timestamps
+		void swap(); // call at a frame boundary on the render thread
+	private:
+		struct Watched {
+			SDL_GPUGraphicsPipeline **pipeline;
+			ShaderDesc vert, frag;
+			PipelineBuilder builder;
+			SDL_Time modified[2] { };
+		};
+		struct WatchedCompute {
+			SDL_GPUComputePipeline **pipeline;
+			const char *filename;
+			SDL_ShaderCross_ComputePipelineMetadata metadata;
+			SDL_Time modified { };
+		};
+		struct Ready {
+			SDL_GPUGraphicsPipeline **pipeline;
+			SDL_GPUGraphicsPipeline *replacement;
+			const char *name;
+			Uint64 detected_ns, built_ns;
+		};
+		struct ReadyCompute {
+			SDL_GPUComputePipeline **pipeline;
+			SDL_GPUComputePipeline *replacement;
+			const char *name;
+			Uint64 detected_ns, built_ns;
+		};
+		static int worker(void *data);
+		void poll(const ContextData &ctx, const bool &force);
+		void pollCompute(const ContextData &ctx, const bool &force);
+		SDL_Time modifiedTime(const ContextData &ctx, const char *filename) const;
+
+		std::vector<Watched> m_watched; // worker thread only once started
+		std::vector<WatchedCompute> m_watched_compute; // worker thread only once started
+		std::vector<Ready> m_ready;
+		std::vector<ReadyCompute> m_ready_compute;
+		SDL_Mutex *m_lock { nullptr };
+		SDL_Condition *m_cond { nullptr };
+		SDL_Thread *m_thread { nullptr };
+		SDL_AtomicInt m_quit { }, m_force { };
+		ContextData m_ctx { };
+		static constexpr Sint32 POLL_INTERVAL_MS { 250 };
+};
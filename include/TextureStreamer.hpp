@@ -0,0 +1,81 @@
+#pragma once
+#include <array>
+#include <deque>
+#include <string>
+#include <vector>
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_gpu.h>
+#include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_surface.h>
+#include <SDL3/SDL_thread.h>
+
+#include "Context.hpp"
+
+using TextureHandle = Uint32;
+constexpr TextureHandle INVALID_TEXTURE { 0xFFFFFFFF };
+
+// Decodes images on worker threads and uploads them in batched copy passes,
+// keeping resident textures under a byte budget by evicting the least recently used.
+// An evicted texture keeps its mips of at most TAIL_SIZE, get() hands those out until
+// the full texture streams back in, and a 1x1 placeholder of the same type before a
+// texture was ever resident. Textures downscaled to fit are restored a level at a time
+// once the budget has room for them again.
+class TextureStreamer {
+	public:
+		static constexpr Uint32 TAIL_SIZE { 64 };
+		TextureStreamer(const Uint64 &t_budget, const Uint32 &t_upload_per_frame, const int &t_worker_count);
+		~TextureStreamer();
+		TextureHandle load2D(const char *filename);
+		TextureHandle loadCube(const std::array<const char*, 6> &filenames); // +X, -X, +Y, -Y, +Z, -Z
+		void update(SDL_GPUCommandBuffer *cmdbuf); // call once per frame, outside of any pass
+		SDL_GPUTexture* get(const TextureHandle &handle);
+		bool isResident(const TextureHandle &handle) const;
+		Uint64 residentBytes() const { return m_resident; }
+	private:
+		enum class State { Queued, Resident, Evicted, Failed };
+		struct Entry {
+			std::vector<std::string> paths;
+			SDL_GPUTextureType type;
+			State state { State::Queued };
+			SDL_GPUTexture *texture { nullptr };
+			Uint64 bytes { };
+			Uint32 width { }, height { }, layers { }; // of texture
+			SDL_GPUTexture *tail { nullptr }; // low mips kept from the last eviction
+			Uint64 tail_bytes { };
+			Uint64 last_used { };
+			Uint32 skip_levels { };
+			bool pending { false }; // a decode job is queued or in flight
+		};
+		struct Job {
+			TextureHandle handle;
+			std::vector<std::string> paths;
+			Uint32 skip_levels;
+		};
+		struct Decoded {
+			TextureHandle handle;
+			std::vector<SDL_Surface*> faces; // empty when decoding failed
+			Uint32 skip_levels;
+		};
+		static int worker(void *data);
+		void decode(const Job &job);
+		void enqueue(const TextureHandle &handle);
+		bool makeRoom(SDL_GPUCommandBuffer *cmdbuf, const Uint64 &bytes); // outside of any pass
+		void keepTail(SDL_GPUCommandBuffer *cmdbuf, Entry &entry);
+		void releaseTail(Entry &entry);
+		void restoreLevels();
+		bool createFallbacks(const ContextData &ctx);
+		TextureHandle request(std::vector<std::string> &&paths, const SDL_GPUTextureType &type);
+
+		std::vector<Entry> m_entries; // main thread only
+		std::deque<Job> m_jobs;
+		SDL_Mutex *m_jobs_lock;
+		SDL_Condition *m_jobs_cond;
+		std::deque<Decoded> m_decoded;
+		SDL_Mutex *m_decoded_lock;
+		std::vector<SDL_Thread*> m_workers;
+		SDL_AtomicInt m_quit { };
+		const Uint64 m_budget;
+		const Uint32 m_upload_per_frame;
+		Uint64 m_resident { }, m_frame { };
+		SDL_GPUTexture *m_fallback_2d { nullptr }, *m_fallback_cube { nullptr };
+};
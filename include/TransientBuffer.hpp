@@ -0,0 +1,39 @@
+#pragma once
+#include <SDL3/SDL_gpu.h>
+
+#include "Context.hpp"
+
+struct TransientAllocation {
+	void *data; // write-only, valid until flush()
+	Uint32 offset; // byte offset into TransientBuffer::get(), for SDL_GPUBufferBinding::offset
+};
+
+// GPU buffer for data that lives a single frame: dynamic vertices, large uniform blocks.
+// Each frame in flight owns a fixed slice, so filling it never waits on the GPU
+// and never allocates once constructed. Allocations past the slice fail.
+//
+// Calling contract, all on the render thread, per frame:
+//   1. allocate() & fill everything the frame will draw from it
+//   2. flush() on the frame's command buffer, after the last allocate() and before the
+//      first pass that reads it; the upload is recorded right there
+//   3. bind get() at the returned offsets in that frame's passes
+// Anything allocated after flush() lands in the next frame's slice and is uploaded by the
+// next flush(), so it must not be drawn this frame. Since SDL storage buffer bindings take
+// no offset, it suits vertex/index data better than storage reads.
+class TransientBuffer {
+	public:
+		static constexpr Uint32 FRAMES_IN_FLIGHT { 3 };
+		static constexpr Uint32 MAX_ALIGN { 256 }; // slices start on this, so any align dividing it holds across slices
+		TransientBuffer(const SDL_GPUBufferUsageFlags &buffer_usage, const Uint32 &t_capacity_per_frame);
+		~TransientBuffer();
+		TransientAllocation allocate(const Uint32 &size, const Uint32 &align = 16); // align must divide MAX_ALIGN
+		void flush(SDL_GPUCommandBuffer *cmdbuf); // once per frame, outside of any pass, after this frame's allocations
+		SDL_GPUBuffer* get() const { return m_buffer; }
+		Uint32 used() const { return m_head; }
+	private:
+		SDL_GPUBuffer *m_buffer { nullptr };
+		SDL_GPUTransferBuffer *m_transfer_buffer { nullptr };
+		Uint8 *m_mapped { nullptr };
+		const Uint32 m_capacity;
+		Uint32 m_head { }, m_slot { };
+};
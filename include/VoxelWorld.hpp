@@ -0,0 +1,106 @@
+#pragma once
+#include <array>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <SDL3/SDL_atomic.h>
+#include <SDL3/SDL_gpu.h>
+#include <SDL3/SDL_mutex.h>
+#include <SDL3/SDL_thread.h>
+
+#include "Buffer.hpp"
+#include "Context.hpp"
+#include "HiZBuffer.hpp"
+#include "Math.hpp"
+#include "TransientBuffer.hpp"
+
+// 8 bytes: chunk local corner (0..32) and a pre-shaded color
+struct VoxelVertex {
+	Uint8 x, y, z, face;
+	Uint8 r, g, b, a;
+};
+
+struct VoxelUniforms {
+	Matrix4x4 view_proj;
+};
+
+// per chunk draw, read at instance rate from vertex buffer slot 1
+struct VoxelInstance {
+	float origin[4]; // world position of the chunk's corner
+};
+
+struct VoxelStats {
+	Uint64 meshes { }, mesh_ns { }, quads { };
+	Uint64 uploads { }, uploaded_bytes { };
+};
+
+// Block world split into CHUNK_SIZE^3 chunks streamed in around the camera.
+// Chunks are generated and greedy meshed on worker threads, finished meshes
+// are uploaded in one batched copy pass per frame.
+class VoxelWorld {
+	public:
+		static constexpr int CHUNK_SIZE { 32 };
+		static constexpr int PADDED_SIZE { CHUNK_SIZE + 2 }; // one voxel of the neighbours on every side
+		static constexpr int HEIGHT_CHUNKS { 2 };
+		static constexpr Uint32 MAX_QUADS { CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE / 2 * 6 }; // checkerboard worst case
+		VoxelWorld(const int &t_load_radius, const Uint32 &t_upload_per_frame, const int &t_worker_count);
+		~VoxelWorld();
+		void update(SDL_GPUCommandBuffer *cmdbuf, const Vector3 &camera_pos); // once per frame, outside of any pass
+		void cull(SDL_GPUCommandBuffer *cmdbuf, HiZBuffer &hiz); // once per frame before the draws & outside of any pass, skips chunks hidden in the last fetched Hi-Z
+		void draw(SDL_GPURenderPass *render_pass, SDL_GPUCommandBuffer *cmdbuf, const Matrix4x4 &view_proj); // pipeline already bound
+		bool setBlock(const int &x, const int &y, const int &z, const Uint8 &block);
+		const VoxelStats& stats() const { return m_stats; }
+		size_t chunkCount() const { return m_chunks.size(); }
+	private:
+		using Volume = std::array<Uint8, PADDED_SIZE * PADDED_SIZE * PADDED_SIZE>;
+		struct Chunk {
+			std::array<int, 3> coord;
+			std::unique_ptr<Volume> volume; // null until generated
+			SDL_GPUBuffer *vertices { nullptr };
+			Uint32 quad_count { };
+			Uint64 version { }, meshed_version { };
+			Uint64 incarnation { }; // the version it was loaded with, tells its results from an unloaded predecessor's
+			bool in_flight { false };
+			bool visible { true };
+			Uint32 instance_offset { }; // of this frame's VoxelInstance in m_instances
+		};
+		struct Job {
+			std::array<int, 3> coord;
+			Uint64 incarnation, version;
+			std::unique_ptr<Volume> volume; // null asks the worker to generate it
+		};
+		struct Result {
+			std::array<int, 3> coord;
+			Uint64 incarnation, version;
+			std::unique_ptr<Volume> volume;
+			std::vector<VoxelVertex> vertices;
+			Uint64 mesh_ns;
+		};
+		static int worker(void *data);
+		static void generate(const std::array<int, 3> &coord, Volume &volume);
+		static void mesh(const Volume &volume, std::vector<VoxelVertex> &vertices);
+		static Uint64 key(const std::array<int, 3> &coord);
+		static int index(const int &x, const int &y, const int &z);
+		void enqueue(Chunk &chunk);
+		void stream(const Vector3 &camera_pos);
+		void upload(SDL_GPUCommandBuffer *cmdbuf);
+		void report();
+
+		std::unordered_map<Uint64, Chunk> m_chunks; // main thread only
+		std::deque<Job> m_jobs;
+		SDL_Mutex *m_jobs_lock;
+		SDL_Condition *m_jobs_cond;
+		std::deque<Result> m_results;
+		SDL_Mutex *m_results_lock;
+		std::vector<SDL_Thread*> m_workers;
+		SDL_AtomicInt m_quit { };
+		Buffer<Uint32> m_quad_indices; // 0 1 2 0 2 3 pattern shared by every chunk
+		TransientBuffer m_instances; // visible chunks' VoxelInstance, rewritten every frame
+		const int m_load_radius;
+		const Uint32 m_upload_per_frame;
+		const Vector3 m_origin { 0, -40, 0 };
+		Uint64 m_next_version { };
+		VoxelStats m_stats;
+		Uint64 m_report_ns { }, m_reported_meshes { }, m_reported_bytes { };
+};
@@ -0,0 +1,213 @@
+#include "ClusteredLighting.hpp"
+#include "Materials.hpp"
+#include "SDL3/SDL_log.h"
+
+const SDL_ShaderCross_ComputePipelineMetadata ClusteredLighting::CULL_METADATA {
+	.num_samplers = 0,
+	.num_readonly_storage_textures = 0,
+	.num_readonly_storage_buffers = 1,
+	.num_readwrite_storage_textures = 0,
+	.num_readwrite_storage_buffers = 2,
+	.num_uniform_buffers = 1,
+	.threadcount_x = CULL_THREADS,
+	.threadcount_y = 1,
+	.threadcount_z = 1
+};
+
+ClusteredLighting::ClusteredLighting() {
+	const ContextData ctx { Context::get()->data() };
+	m_cull_pipeline = LoadComputePipeline(ctx, "ClusterCull.comp", CULL_METADATA);
+	if (m_cull_pipeline == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "loadComputePipeline failed");
+		return;
+	}
+	const SDL_GPUBufferCreateInfo light_buff_info {
+		.usage = SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_READ | SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ,
+		.size = static_cast<Uint32>(sizeof(PointLight) * MAX_LIGHTS)
+	};
+	m_light_buffer = SDL_CreateGPUBuffer(ctx.gpu, &light_buff_info);
+	const SDL_GPUBufferCreateInfo cluster_buff_info {
+		.usage = SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_WRITE | SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ,
+		.size = static_cast<Uint32>(sizeof(Uint32) * GRID_X * GRID_Y * GRID_Z * (MAX_LIGHTS_PER_CLUSTER + 1))
+	};
+	m_cluster_buffer = SDL_CreateGPUBuffer(ctx.gpu, &cluster_buff_info);
+	if (m_light_buffer == nullptr || m_cluster_buffer == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateGPUBuffer failed: %s", SDL_GetError());
+		return;
+	}
+	const SDL_GPUTransferBufferCreateInfo trans_buff_info {
+		.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+		.size = light_buff_info.size
+	};
+	m_transfer_buffer = SDL_CreateGPUTransferBuffer(ctx.gpu, &trans_buff_info);
+	if (m_transfer_buffer == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateGPUTransferBuffer failed: %s", SDL_GetError());
+		return;
+	}
+	// lights dropped past the per cluster cap, zeroed & read back every cull
+	const SDL_GPUBufferCreateInfo overflow_buff_info {
+		.usage = SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_WRITE,
+		.size = sizeof(ClusterOverflow)
+	};
+	m_overflow_buffer = SDL_CreateGPUBuffer(ctx.gpu, &overflow_buff_info);
+	if (m_overflow_buffer == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateGPUBuffer failed: %s", SDL_GetError());
+		return;
+	}
+	const SDL_GPUTransferBufferCreateInfo zero_buff_info {
+		.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+		.size = sizeof(ClusterOverflow)
+	};
+	m_overflow_zero = SDL_CreateGPUTransferBuffer(ctx.gpu, &zero_buff_info);
+	const SDL_GPUTransferBufferCreateInfo readback_buff_info {
+		.usage = SDL_GPU_TRANSFERBUFFERUSAGE_DOWNLOAD,
+		.size = sizeof(ClusterOverflow)
+	};
+	m_overflow_readback = SDL_CreateGPUTransferBuffer(ctx.gpu, &readback_buff_info);
+	if (m_overflow_zero == nullptr || m_overflow_readback == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateGPUTransferBuffer failed: %s", SDL_GetError());
+		return;
+	}
+	ClusterOverflow *zero { static_cast<ClusterOverflow*>(SDL_MapGPUTransferBuffer(ctx.gpu, m_overflow_zero, false)) };
+	if (zero == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "MapGPUTransferBuffer failed: %s", SDL_GetError());
+		return;
+	}
+	*zero = ClusterOverflow { 0, 0 };
+	SDL_UnmapGPUTransferBuffer(ctx.gpu, m_overflow_zero);
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Created ClusteredLighting:\n\tClusters: %ux%ux%u\n\tMax lights: %u\n\tMax lights per cluster: %u", GRID_X, GRID_Y, GRID_Z, MAX_LIGHTS, MAX_LIGHTS_PER_CLUSTER);
+}
+
+ClusteredLighting::~ClusteredLighting() {
+	const ContextData ctx { Context::get()->data() };
+	SDL_ReleaseGPUTransferBuffer(ctx.gpu, m_overflow_readback);
+	SDL_ReleaseGPUTransferBuffer(ctx.gpu, m_overflow_zero);
+	SDL_ReleaseGPUBuffer(ctx.gpu, m_overflow_buffer);
+	SDL_ReleaseGPUTransferBuffer(ctx.gpu, m_transfer_buffer);
+	SDL_ReleaseGPUBuffer(ctx.gpu, m_cluster_buffer);
+	SDL_ReleaseGPUBuffer(ctx.gpu, m_light_buffer);
+	SDL_ReleaseGPUComputePipeline(ctx.gpu, m_cull_pipeline);
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Released ClusteredLighting");
+}
+
+void ClusteredLighting::setLights(const PointLight *lights, const Uint32 &count) {
+	if (count > MAX_LIGHTS) {
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "ClusteredLighting: %u lights requested, keeping the first %u", count, MAX_LIGHTS);
+	}
+	m_lights.assign(lights, lights + SDL_min(count, MAX_LIGHTS));
+	m_dirty = true;
+}
+
+void ClusteredLighting::scatterLights(const Uint32 &count, Uint64 seed) {
+	std::vector<PointLight> lights(count);
+	for (PointLight &light : lights) {
+		light.position[0] = SDL_randf_r(&seed) * 192.0f - 96.0f;
+		light.position[1] = SDL_randf_r(&seed) * 20.0f - 25.0f;
+		light.position[2] = SDL_randf_r(&seed) * 192.0f - 96.0f;
+		light.radius = 16.0f;
+		light.color[0] = 0.25f + SDL_randf_r(&seed) * 0.75f;
+		light.color[1] = 0.25f + SDL_randf_r(&seed) * 0.75f;
+		light.color[2] = 0.25f + SDL_randf_r(&seed) * 0.75f;
+		light.intensity = 1.5f;
+	}
+	setLights(lights.data(), count);
+}
+
+ClusterUniforms ClusteredLighting::uniforms(const Matrix4x4 &view, const float &fov, const float &aspect, const float near_far[2]) const {
+	const ContextData ctx { Context::get()->data() };
+	return ClusterUniforms {
+		.view = view,
+		.near_far = { near_far[0], near_far[1] },
+		.tan_half_fov = SDL_tanf(fov * 0.5f),
+		.aspect = aspect,
+		.grid = { GRID_X, GRID_Y, GRID_Z, MAX_LIGHTS_PER_CLUSTER },
+		.screen_size = { static_cast<float>(ctx.width), static_cast<float>(ctx.height) },
+		.light_count = lightCount(),
+		.padding = 0
+	};
+}
+
+void ClusteredLighting::cull(SDL_GPUCommandBuffer *cmdbuf, const ClusterUniforms &uniforms) {
+	if (m_cull_pipeline == nullptr || m_transfer_buffer == nullptr || m_overflow_readback == nullptr) {
+		return;
+	}
+	const ContextData ctx { Context::get()->data() };
+	if (m_dirty && !m_lights.empty()) {
+		PointLight *transfer_data { static_cast<PointLight*>(SDL_MapGPUTransferBuffer(ctx.gpu, m_transfer_buffer, true)) };
+		if (transfer_data == nullptr) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "MapGPUTransferBuffer failed: %s", SDL_GetError());
+			return;
+		}
+		SDL_memcpy(transfer_data, m_lights.data(), sizeof(PointLight) * m_lights.size());
+		SDL_UnmapGPUTransferBuffer(ctx.gpu, m_transfer_buffer);
+	}
+	SDL_GPUCopyPass *copy_pass { SDL_BeginGPUCopyPass(cmdbuf) };
+	if (m_dirty && !m_lights.empty()) {
+		const SDL_GPUTransferBufferLocation transfer_buffer_loc {
+			.transfer_buffer = m_transfer_buffer,
+			.offset = 0
+		};
+		const SDL_GPUBufferRegion buffer_region {
+			.buffer = m_light_buffer,
+			.offset = 0,
+			.size = static_cast<Uint32>(sizeof(PointLight) * m_lights.size())
+		};
+		SDL_UploadToGPUBuffer(copy_pass, &transfer_buffer_loc, &buffer_region, true);
+	}
+	m_dirty = false;
+	const SDL_GPUTransferBufferLocation zero_loc {
+		.transfer_buffer = m_overflow_zero,
+		.offset = 0
+	};
+	const SDL_GPUBufferRegion overflow_region {
+		.buffer = m_overflow_buffer,
+		.offset = 0,
+		.size = sizeof(ClusterOverflow)
+	};
+	SDL_UploadToGPUBuffer(copy_pass, &zero_loc, &overflow_region, true);
+	SDL_EndGPUCopyPass(copy_pass);
+	// every cluster is rewritten, so last frame's contents can be discarded
+	const SDL_GPUStorageBufferReadWriteBinding readwrite_bindings[2] {
+		{ m_cluster_buffer, true },
+		{ m_overflow_buffer, false }
+	};
+	SDL_GPUComputePass *compute_pass { SDL_BeginGPUComputePass(cmdbuf, NULL, 0, readwrite_bindings, 2) };
+	SDL_BindGPUComputePipeline(compute_pass, m_cull_pipeline);
+	SDL_BindGPUComputeStorageBuffers(compute_pass, 0, &m_light_buffer, 1);
+	SDL_PushGPUComputeUniformData(cmdbuf, 0, &uniforms, sizeof(uniforms));
+	SDL_DispatchGPUCompute(compute_pass, (GRID_X * GRID_Y * GRID_Z + CULL_THREADS - 1) / CULL_THREADS, 1, 1);
+	SDL_EndGPUComputePass(compute_pass);
+	copy_pass = SDL_BeginGPUCopyPass(cmdbuf);
+	const SDL_GPUTransferBufferLocation readback_loc {
+		.transfer_buffer = m_overflow_readback,
+		.offset = 0
+	};
+	SDL_DownloadFromGPUBuffer(copy_pass, &overflow_region, &readback_loc);
+	SDL_EndGPUCopyPass(copy_pass);
+}
+
+ClusterOverflow ClusteredLighting::overflow() const {
+	if (m_overflow_readback == nullptr) {
+		return ClusterOverflow { 0, 0 };
+	}
+	const ContextData ctx { Context::get()->data() };
+	const ClusterOverflow *data { static_cast<const ClusterOverflow*>(SDL_MapGPUTransferBuffer(ctx.gpu, m_overflow_readback, false)) };
+	if (data == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "MapGPUTransferBuffer failed: %s", SDL_GetError());
+		return ClusterOverflow { 0, 0 };
+	}
+	const ClusterOverflow result { *data };
+	SDL_UnmapGPUTransferBuffer(ctx.gpu, m_overflow_readback);
+	return result;
+}
+
+void ClusteredLighting::bind(SDL_GPURenderPass *render_pass) {
+	SDL_GPUBuffer *const storage_buffers[2] { m_light_buffer, m_cluster_buffer };
+	SDL_BindGPUFragmentStorageBuffers(render_pass, 0, storage_buffers, 2);
+}
+
+void ClusteredLighting::watchShaders(ShaderReloader &reloader) {
+	if (m_cull_pipeline != nullptr) {
+		reloader.watch(&m_cull_pipeline, "ClusterCull.comp", CULL_METADATA);
+	}
+}
@@ -0,0 +1,105 @@
+#include "FrameArena.hpp"
+#include "SDL3/SDL_log.h"
+
+namespace {
+	constexpr size_t MIN_BLOCK_SIZE { 4096 };
+	constexpr size_t BLOCK_ALIGN { 64 };
+
+	size_t AlignUp(const size_t &value, const size_t &align) {
+		return (value + align - 1) & ~(align - 1);
+	}
+}
+
+LinearArena::~LinearArena() {
+	// free the overflow chain as is, folding it like reset() would only allocate a block to throw away
+	while (m_overflow != nullptr) {
+		Overflow *next { m_overflow->next };
+		SDL_aligned_free(m_overflow);
+		m_overflow = next;
+	}
+	SDL_aligned_free(m_data);
+}
+
+void LinearArena::reserve(const size_t &t_capacity) {
+	if (t_capacity <= m_capacity) {
+		return;
+	}
+	SDL_aligned_free(m_data);
+	m_data = static_cast<Uint8*>(SDL_aligned_alloc(BLOCK_ALIGN, t_capacity));
+	m_capacity = m_data == nullptr ? 0 : t_capacity;
+	m_used = 0;
+	++m_heap_allocations;
+}
+
+void* LinearArena::allocate(const size_t &size, const size_t &align) {
+	const size_t offset { AlignUp(m_used, align) };
+	if (offset + size <= m_capacity) {
+		m_used = offset + size;
+		return m_data + offset;
+	}
+	// the header keeps the payload aligned to BLOCK_ALIGN
+	if (m_overflow != nullptr) {
+		Uint8 *base { reinterpret_cast<Uint8*>(m_overflow) + BLOCK_ALIGN };
+		const size_t overflow_offset { AlignUp(m_overflow->used, align) };
+		if (overflow_offset + size <= m_overflow->size) {
+			m_overflow_used += overflow_offset + size - m_overflow->used;
+			m_overflow->used = overflow_offset + size;
+			return base + overflow_offset;
+		}
+	}
+	const size_t block_size { SDL_max(AlignUp(size + align, BLOCK_ALIGN), SDL_max(m_capacity, MIN_BLOCK_SIZE)) };
+	Overflow *block { static_cast<Overflow*>(SDL_aligned_alloc(BLOCK_ALIGN, BLOCK_ALIGN + block_size)) };
+	if (block == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "LinearArena overflow allocation failed: %s", SDL_GetError());
+		return nullptr;
+	}
+	++m_heap_allocations;
+	block->next = m_overflow;
+	block->size = block_size;
+	block->used = 0;
+	m_overflow = block;
+	return allocate(size, align);
+}
+
+void LinearArena::reset() {
+	// fold the overflow chain into the main block so the next frame fits
+	size_t grown { m_capacity };
+	while (m_overflow != nullptr) {
+		Overflow *next { m_overflow->next };
+		grown += m_overflow->size;
+		SDL_aligned_free(m_overflow);
+		m_overflow = next;
+	}
+	if (grown > m_capacity) {
+		reserve(grown);
+	}
+	m_used = 0;
+	m_overflow_used = 0;
+}
+
+FrameArena::FrameArena(const size_t &t_capacity_per_thread) {
+	// workers reserve lazily on first use
+	m_arenas.at(0).reserve(t_capacity_per_thread);
+}
+
+Uint64 FrameArena::heapAllocations() const {
+	Uint64 total { };
+	for (const LinearArena &arena : m_arenas) {
+		total += arena.heapAllocations();
+	}
+	return total;
+}
+
+void FrameArena::reset() {
+	for (LinearArena &arena : m_arenas) {
+		arena.reset();
+	}
+	// steady state must not touch the heap, report any growth once warmed up
+	const Uint64 heap_allocations { heapAllocations() };
+	if (++m_frame > WARM_UP_FRAMES && heap_allocations != m_last_heap_allocations) {
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "FrameArena hit the heap in steady state:\n\tFrame: %llu\n\tAllocations: %llu",
+			static_cast<unsigned long long>(m_frame),
+			static_cast<unsigned long long>(heap_allocations - m_last_heap_allocations));
+	}
+	m_last_heap_allocations = heap_allocations;
+}
@@ -0,0 +1,399 @@
+#include "HiZBuffer.hpp"
+#include "Materials.hpp"
+#include "SDL3/SDL_log.h"
+
+const SDL_ShaderCross_ComputePipelineMetadata HiZBuffer::COPY_METADATA {
+	.num_samplers = 1,
+	.num_readonly_storage_textures = 0,
+	.num_readonly_storage_buffers = 0,
+	.num_readwrite_storage_textures = 1,
+	.num_readwrite_storage_buffers = 1,
+	.num_uniform_buffers = 1,
+	.threadcount_x = BUILD_THREADS,
+	.threadcount_y = BUILD_THREADS,
+	.threadcount_z = 1
+};
+
+const SDL_ShaderCross_ComputePipelineMetadata HiZBuffer::REDUCE_METADATA {
+	.num_samplers = 1,
+	.num_readonly_storage_textures = 0,
+	.num_readonly_storage_buffers = 0,
+	.num_readwrite_storage_textures = 1,
+	.num_readwrite_storage_buffers = 0,
+	.num_uniform_buffers = 1,
+	.threadcount_x = BUILD_THREADS,
+	.threadcount_y = BUILD_THREADS,
+	.threadcount_z = 1
+};
+
+HiZBuffer::HiZBuffer() {
+	const ContextData ctx { Context::get()->data() };
+	m_copy_pipeline = LoadComputePipeline(ctx, "HiZCopy.comp", COPY_METADATA);
+	m_reduce_pipeline = LoadComputePipeline(ctx, "HiZReduce.comp", REDUCE_METADATA);
+	if (m_copy_pipeline == nullptr || m_reduce_pipeline == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "loadComputePipeline failed");
+		return;
+	}
+	const SDL_GPUSamplerCreateInfo sampler_create {
+		.min_filter = SDL_GPU_FILTER_NEAREST,
+		.mag_filter = SDL_GPU_FILTER_NEAREST,
+		.mipmap_mode = SDL_GPU_SAMPLERMIPMAPMODE_NEAREST,
+		.address_mode_u = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+		.address_mode_v = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+		.address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE
+	};
+	m_sampler = SDL_CreateGPUSampler(ctx.gpu, &sampler_create);
+	if (m_sampler == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateGPUSampler failed: %s", SDL_GetError());
+		return;
+	}
+	// halve down to 1x1
+	Uint32 width { ctx.width }, height { ctx.height };
+	while (true) {
+		m_sizes.push_back({ width, height });
+		if (width == 1 && height == 1) {
+			break;
+		}
+		width = SDL_max(width / 2, 1u);
+		height = SDL_max(height / 2, 1u);
+	}
+	for (const std::array<Uint32, 2> &size : m_sizes) {
+		const SDL_GPUTextureCreateInfo level_create {
+			.type = SDL_GPU_TEXTURETYPE_2D,
+			.format = SDL_GPU_TEXTUREFORMAT_R32_FLOAT,
+			.usage = SDL_GPU_TEXTUREUSAGE_SAMPLER | SDL_GPU_TEXTUREUSAGE_COMPUTE_STORAGE_WRITE,
+			.width = size.at(0),
+			.height = size.at(1),
+			.layer_count_or_depth = 1,
+			.num_levels = 1,
+			.sample_count = SDL_GPU_SAMPLECOUNT_1
+		};
+		SDL_GPUTexture *level { SDL_CreateGPUTexture(ctx.gpu, &level_create) };
+		if (level == nullptr) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateGPUTexture failed: %s", SDL_GetError());
+			return;
+		}
+		m_levels.push_back(level);
+	}
+	// the CPU only gets the coarse end of the chain
+	while (m_readback_level + 1 < m_sizes.size() && m_sizes.at(m_readback_level).at(0) > READBACK_WIDTH) {
+		++m_readback_level;
+	}
+	Uint32 texels { };
+	for (size_t level = m_readback_level; level < m_sizes.size(); ++level) {
+		m_offsets.push_back(texels);
+		texels += m_sizes.at(level).at(0) * m_sizes.at(level).at(1);
+	}
+	m_depth.resize(texels);
+	const SDL_GPUBufferCreateInfo covered_buff_info {
+		.usage = SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_WRITE,
+		.size = sizeof(Uint32)
+	};
+	m_covered = SDL_CreateGPUBuffer(ctx.gpu, &covered_buff_info);
+	if (m_covered == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateGPUBuffer failed: %s", SDL_GetError());
+		return;
+	}
+	const SDL_GPUTransferBufferCreateInfo zero_buff_info {
+		.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+		.size = sizeof(Uint32)
+	};
+	m_zero = SDL_CreateGPUTransferBuffer(ctx.gpu, &zero_buff_info);
+	if (m_zero == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateGPUTransferBuffer failed: %s", SDL_GetError());
+		return;
+	}
+	const SDL_GPUTransferBufferCreateInfo readback_buff_info {
+		.usage = SDL_GPU_TRANSFERBUFFERUSAGE_DOWNLOAD,
+		.size = static_cast<Uint32>(sizeof(float) * texels + sizeof(Uint32))
+	};
+	for (Readback &readback : m_readbacks) {
+		readback.buffer = SDL_CreateGPUTransferBuffer(ctx.gpu, &readback_buff_info);
+		if (readback.buffer == nullptr) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateGPUTransferBuffer failed: %s", SDL_GetError());
+			return;
+		}
+	}
+	Uint32 *zero { static_cast<Uint32*>(SDL_MapGPUTransferBuffer(ctx.gpu, m_zero, false)) };
+	if (zero == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "MapGPUTransferBuffer failed: %s", SDL_GetError());
+		return;
+	}
+	*zero = 0;
+	SDL_UnmapGPUTransferBuffer(ctx.gpu, m_zero);
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Created HiZBuffer:\n\tLevels: %zu\n\tRead back from: %ux%u", m_levels.size(), m_sizes.at(m_readback_level).at(0), m_sizes.at(m_readback_level).at(1));
+}
+
+HiZBuffer::~HiZBuffer() {
+	const ContextData ctx { Context::get()->data() };
+	for (Readback &readback : m_readbacks) {
+		if (readback.fence != nullptr) {
+			SDL_WaitForGPUFences(ctx.gpu, true, &readback.fence, 1);
+			SDL_ReleaseGPUFence(ctx.gpu, readback.fence);
+		}
+		SDL_ReleaseGPUTransferBuffer(ctx.gpu, readback.buffer);
+	}
+	SDL_ReleaseGPUTransferBuffer(ctx.gpu, m_zero);
+	SDL_ReleaseGPUBuffer(ctx.gpu, m_covered);
+	for (SDL_GPUTexture *level : m_levels) {
+		SDL_ReleaseGPUTexture(ctx.gpu, level);
+	}
+	SDL_ReleaseGPUSampler(ctx.gpu, m_sampler);
+	SDL_ReleaseGPUComputePipeline(ctx.gpu, m_reduce_pipeline);
+	SDL_ReleaseGPUComputePipeline(ctx.gpu, m_copy_pipeline);
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Released HiZBuffer");
+}
+
+void HiZBuffer::fetch(const Vector3 &camera_pos) {
+	const ContextData ctx { Context::get()->data() };
+	// free every finished slot, only the newest one is worth reading
+	Readback *newest { nullptr };
+	for (Readback &readback : m_readbacks) {
+		if (readback.fence == nullptr || !SDL_QueryGPUFence(ctx.gpu, readback.fence)) {
+			continue;
+		}
+		SDL_ReleaseGPUFence(ctx.gpu, readback.fence);
+		readback.fence = nullptr;
+		if (newest == nullptr || readback.frame > newest->frame) {
+			newest = &readback;
+		}
+	}
+	if (newest != nullptr && (!m_valid || newest->frame > m_fetched_frame)) {
+		const Uint8 *data { static_cast<const Uint8*>(SDL_MapGPUTransferBuffer(ctx.gpu, newest->buffer, false)) };
+		if (data == nullptr) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "MapGPUTransferBuffer failed: %s", SDL_GetError());
+		} else {
+			SDL_memcpy(m_depth.data(), data, sizeof(float) * m_depth.size());
+			SDL_memcpy(&m_covered_pixels, data + sizeof(float) * m_depth.size(), sizeof(Uint32));
+			SDL_UnmapGPUTransferBuffer(ctx.gpu, newest->buffer);
+			m_view_proj = newest->view_proj;
+			m_near_far[0] = newest->near_far[0];
+			m_near_far[1] = newest->near_far[1];
+			m_camera_pos = newest->camera_pos;
+			// the view rows are orthonormal, so the length of a column's first three rows is the projection's scale
+			for (int c = 0; c < 2; ++c) {
+				m_scale[c] = SDL_sqrtf(m_view_proj.at(0).at(c) * m_view_proj.at(0).at(c) + m_view_proj.at(1).at(c) * m_view_proj.at(1).at(c) + m_view_proj.at(2).at(c) * m_view_proj.at(2).at(c));
+			}
+			m_fetched_frame = newest->frame;
+			m_valid = true;
+		}
+	}
+	if (!m_valid) {
+		return;
+	}
+	const Vector3 drift { camera_pos.at(0) - m_camera_pos.at(0), camera_pos.at(1) - m_camera_pos.at(1), camera_pos.at(2) - m_camera_pos.at(2) };
+	m_drift = SDL_sqrtf(drift.dot(drift));
+	m_drift_sum += m_drift;
+	m_age += m_frames - m_fetched_frame;
+	++m_fetched_frames;
+}
+
+void HiZBuffer::build(SDL_GPUCommandBuffer *cmdbuf, SDL_GPUTexture *depth, const Matrix4x4 &view_proj, const float near_far[2], const Vector3 &camera_pos) {
+	// the pyramid is only of use to the CPU, skip building it while no slot is free to read it back into
+	Readback *readback { nullptr };
+	for (Readback &slot : m_readbacks) {
+		if (slot.fence == nullptr) {
+			readback = &slot;
+			break;
+		}
+	}
+	if (m_levels.size() != m_sizes.size() || readback == nullptr || readback->buffer == nullptr) {
+		return;
+	}
+	// the coverage count starts from zero every build
+	SDL_GPUCopyPass *copy_pass { SDL_BeginGPUCopyPass(cmdbuf) };
+	const SDL_GPUTransferBufferLocation zero_loc {
+		.transfer_buffer = m_zero,
+		.offset = 0
+	};
+	const SDL_GPUBufferRegion covered_region {
+		.buffer = m_covered,
+		.offset = 0,
+		.size = sizeof(Uint32)
+	};
+	SDL_UploadToGPUBuffer(copy_pass, &zero_loc, &covered_region, true);
+	SDL_EndGPUCopyPass(copy_pass);
+	for (size_t level = 0; level < m_levels.size(); ++level) {
+		// every texel is rewritten, so the texture can be cycled away from pending readbacks
+		const SDL_GPUStorageTextureReadWriteBinding level_binding {
+			.texture = m_levels.at(level),
+			.mip_level = 0,
+			.layer = 0,
+			.cycle = true
+		};
+		const SDL_GPUStorageBufferReadWriteBinding covered_binding { m_covered, false };
+		SDL_GPUComputePass *compute_pass { SDL_BeginGPUComputePass(cmdbuf, &level_binding, 1, &covered_binding, level == 0 ? 1 : 0) };
+		const SDL_GPUTextureSamplerBinding source_binding { level == 0 ? depth : m_levels.at(level - 1), m_sampler };
+		const std::array<Uint32, 2> &source_size { m_sizes.at(level == 0 ? 0 : level - 1) };
+		const std::array<Uint32, 2> &size { m_sizes.at(level) };
+		const HiZUniforms uniforms {
+			.source_size = { source_size.at(0), source_size.at(1) },
+			.destination_size = { size.at(0), size.at(1) }
+		};
+		SDL_BindGPUComputePipeline(compute_pass, level == 0 ? m_copy_pipeline : m_reduce_pipeline);
+		SDL_BindGPUComputeSamplers(compute_pass, 0, &source_binding, 1);
+		SDL_PushGPUComputeUniformData(cmdbuf, 0, &uniforms, sizeof(uniforms));
+		SDL_DispatchGPUCompute(compute_pass, (size.at(0) + BUILD_THREADS - 1) / BUILD_THREADS, (size.at(1) + BUILD_THREADS - 1) / BUILD_THREADS, 1);
+		SDL_EndGPUComputePass(compute_pass);
+	}
+	copy_pass = SDL_BeginGPUCopyPass(cmdbuf);
+	for (size_t level = m_readback_level; level < m_levels.size(); ++level) {
+		const std::array<Uint32, 2> &size { m_sizes.at(level) };
+		const SDL_GPUTextureRegion level_region {
+			.texture = m_levels.at(level),
+			.mip_level = 0,
+			.layer = 0,
+			.x = 0,
+			.y = 0,
+			.z = 0,
+			.w = size.at(0),
+			.h = size.at(1),
+			.d = 1
+		};
+		const SDL_GPUTextureTransferInfo readback_info {
+			.transfer_buffer = readback->buffer,
+			.offset = static_cast<Uint32>(sizeof(float) * m_offsets.at(level - m_readback_level)),
+			.pixels_per_row = size.at(0),
+			.rows_per_layer = size.at(1)
+		};
+		SDL_DownloadFromGPUTexture(copy_pass, &level_region, &readback_info);
+	}
+	const SDL_GPUTransferBufferLocation covered_loc {
+		.transfer_buffer = readback->buffer,
+		.offset = static_cast<Uint32>(sizeof(float) * m_depth.size())
+	};
+	SDL_DownloadFromGPUBuffer(copy_pass, &covered_region, &covered_loc);
+	SDL_EndGPUCopyPass(copy_pass);
+	readback->view_proj = view_proj;
+	readback->near_far[0] = near_far[0];
+	readback->near_far[1] = near_far[1];
+	readback->camera_pos = camera_pos;
+	readback->frame = m_frames;
+	m_recorded = readback;
+}
+
+void HiZBuffer::submit(SDL_GPUCommandBuffer *cmdbuf) {
+	if (m_recorded == nullptr) {
+		SDL_SubmitGPUCommandBuffer(cmdbuf);
+		return;
+	}
+	m_recorded->fence = SDL_SubmitGPUCommandBufferAndAcquireFence(cmdbuf);
+	const bool fenced { m_recorded->fence != nullptr };
+	m_recorded = nullptr;
+	if (!fenced) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SubmitGPUCommandBufferAndAcquireFence failed: %s", SDL_GetError());
+	}
+}
+
+bool HiZBuffer::occluded(const Vector3 &box_min, const Vector3 &box_max) {
+	++m_tested;
+	if (!m_valid) {
+		return false;
+	}
+	// screen rect & nearest view distance of the box, seen from where the fetched depth was drawn
+	float min_x { 1.0f }, max_x { -1.0f }, min_y { 1.0f }, max_y { -1.0f }, nearest_w { m_near_far[1] };
+	for (int i = 0; i < 8; ++i) {
+		const float x { i & 1 ? box_max.at(0) : box_min.at(0) };
+		const float y { i & 2 ? box_max.at(1) : box_min.at(1) };
+		const float z { i & 4 ? box_max.at(2) : box_min.at(2) };
+		float clip[4];
+		for (int c = 0; c < 4; ++c) {
+			clip[c] = x * m_view_proj.at(0).at(c) + y * m_view_proj.at(1).at(c) + z * m_view_proj.at(2).at(c) + m_view_proj.at(3).at(c);
+		}
+		if (clip[3] <= 0.0f) {
+			return false; // reaches behind the camera
+		}
+		min_x = SDL_min(min_x, clip[0] / clip[3]);
+		max_x = SDL_max(max_x, clip[0] / clip[3]);
+		min_y = SDL_min(min_y, clip[1] / clip[3]);
+		max_y = SDL_max(max_y, clip[1] / clip[3]);
+		nearest_w = SDL_min(nearest_w, clip[3]);
+	}
+	// from where the camera is now, a point at view distance w is at most drift nearer & moves on
+	// screen by at most (scale + |ndc|) * drift / (w - drift), measured in the fetched view's orientation
+	const float near_w { nearest_w - m_drift };
+	if (near_w <= m_near_far[0]) {
+		return false; // may cross the near plane
+	}
+	const float reach { m_drift / near_w };
+	min_x -= (m_scale[0] + 1.0f) * reach;
+	max_x += (m_scale[0] + 1.0f) * reach;
+	min_y -= (m_scale[1] + 1.0f) * reach;
+	max_y += (m_scale[1] + 1.0f) * reach;
+	if (min_x < -1.0f || max_x > 1.0f || min_y < -1.0f || max_y > 1.0f) {
+		// reaches off screen, where the fetched depth has nothing to say about the part the
+		// camera may have turned towards since
+		return false;
+	}
+	// reverse-Z, nearer is larger
+	const float nearest { m_near_far[0] * (m_near_far[1] - near_w) / ((m_near_far[1] - m_near_far[0]) * near_w) };
+	const float u0 { (min_x + 1.0f) * 0.5f }, u1 { (max_x + 1.0f) * 0.5f };
+	const float v0 { (1.0f - max_y) * 0.5f }, v1 { (1.0f - min_y) * 0.5f };
+	// the finest read back level the rect covers a handful of texels on, widened by a texel
+	// on every side as odd sizes don't halve evenly
+	size_t level { m_readback_level };
+	int x0, x1, y0, y1;
+	while (true) {
+		const int width { static_cast<int>(m_sizes.at(level).at(0)) }, height { static_cast<int>(m_sizes.at(level).at(1)) };
+		x0 = SDL_max(static_cast<int>(u0 * width) - 1, 0);
+		x1 = SDL_min(static_cast<int>(SDL_ceilf(u1 * width)) + 1, width);
+		y0 = SDL_max(static_cast<int>(v0 * height) - 1, 0);
+		y1 = SDL_min(static_cast<int>(SDL_ceilf(v1 * height)) + 1, height);
+		if ((x1 - x0 <= 8 && y1 - y0 <= 8) || level + 1 == m_sizes.size()) {
+			break;
+		}
+		++level;
+	}
+	const float *depth { m_depth.data() + m_offsets.at(level - m_readback_level) };
+	const Uint32 width { m_sizes.at(level).at(0) };
+	float farthest { 1.0f };
+	for (int y = y0; y < y1; ++y) {
+		for (int x = x0; x < x1; ++x) {
+			farthest = SDL_min(farthest, depth[y * width + x]);
+		}
+	}
+	if (nearest < farthest) {
+		++m_rejected;
+		return true;
+	}
+	return false;
+}
+
+void HiZBuffer::watchShaders(ShaderReloader &reloader) {
+	if (m_copy_pipeline != nullptr && m_reduce_pipeline != nullptr) {
+		reloader.watch(&m_copy_pipeline, "HiZCopy.comp", COPY_METADATA);
+		reloader.watch(&m_reduce_pipeline, "HiZReduce.comp", REDUCE_METADATA);
+	}
+}
+
+void HiZBuffer::report(const bool &depth_prepass) {
+	++m_frames;
+	const Uint64 now_ns { SDL_GetTicksNS() };
+	if (m_report_ns == 0) {
+		m_report_ns = now_ns;
+		return;
+	}
+	if (now_ns - m_report_ns < 2000 * SDL_NS_PER_MS) {
+		return;
+	}
+	const double frames { static_cast<double>(m_frames - m_reported_frames) };
+	// with the pre-pass every covered pixel is lit once, without it overdraw comes on top. The sky
+	// shades exactly the pixels left uncovered
+	const Uint32 pixels { m_sizes.empty() ? 0 : m_sizes.at(0).at(0) * m_sizes.at(0).at(1) };
+	const double fetched_frames { static_cast<double>(SDL_max(m_fetched_frames - m_reported_fetched_frames, 1)) };
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "HiZBuffer:\n\tObjects rejected: %.1f of %.1f per frame\n\tDepth tested against: %.1f frames old, camera moved %.2f since\n\tFragments shaded: %s%u lit + %u sky per frame",
+		(m_rejected - m_reported_rejected) / frames,
+		(m_tested - m_reported_tested) / frames,
+		(m_age - m_reported_age) / fetched_frames,
+		(m_drift_sum - m_reported_drift_sum) / fetched_frames,
+		depth_prepass ? "" : "at least ",
+		m_covered_pixels,
+		pixels - SDL_min(m_covered_pixels, pixels));
+	m_report_ns = now_ns;
+	m_reported_frames = m_frames;
+	m_reported_tested = m_tested;
+	m_reported_rejected = m_rejected;
+	m_reported_fetched_frames = m_fetched_frames;
+	m_reported_age = m_age;
+	m_reported_drift_sum = m_drift_sum;
+}
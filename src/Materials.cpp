@@ -4,31 +4,86 @@
 #include "SDL3_shadercross/SDL_shadercross.h"
 
 SceneMaterial::SceneMaterial()
-	: m_world_v(24), m_world_i(36), m_screen_v(4), m_screen_i(6) {
+	: m_world_v(24), m_world_i(36), m_screen_v(4), m_screen_i(6), m_skybox_v(24), m_skybox_i(36),
+	m_textures(256 * 1024 * 1024, 16 * 1024 * 1024, 2),
+	m_frame_arena(64 * 1024),
+	m_voxels(3, 4 * 1024 * 1024, SDL_max(SDL_GetNumLogicalCPUCores() - 2, 1)) {
 	init();
 }
 
+namespace {
+	// reverse-Z: cleared to 0, nearer fragments win
+	constexpr SDL_GPUTextureFormat DEPTH_FORMAT { SDL_GPU_TEXTUREFORMAT_D32_FLOAT };
+	// pairs of vertex & fragment shaders, one per pipeline
+	constexpr ShaderDesc SHADERS[12] {
+		{ "PositionColorTransform.vert", 0, 1, 0, 0 },
+		{ "ClusteredLit.frag", 0, 1, 2, 0 },
+		{ "TexturedQuad.vert", 0, 0, 0, 0 },
+		{ "DepthOutline.frag", 2, 1, 0, 0 },
+		{ "Skybox.vert", 0, 1, 0, 0 },
+		{ "Skybox.frag", 1, 0, 0, 0 },
+		{ "VoxelChunk.vert", 0, 1, 0, 0 },
+		{ "ClusteredLit.frag", 0, 1, 2, 0 },
+		{ "PositionColorTransform.vert", 0, 1, 0, 0 },
+		{ "DepthOnly.frag", 0, 0, 0, 0 },
+		{ "VoxelChunk.vert", 0, 1, 0, 0 },
+		{ "DepthOnly.frag", 0, 0, 0, 0 }
+	};
+}
+
 bool SceneMaterial::loadShaders(const ContextData &ctx) {
-	const char *shader_files[4] {
-		"PositionColorTransform.vert",
-		"SolidColorDepth.frag",
-		"TexturedQuad.vert",
-		"DepthOutline.frag"
-	};
-	m_shaders.at(0) = LoadShader(ctx, shader_files[0], 0, 1, 0, 0);
-	m_shaders.at(1) = LoadShader(ctx, shader_files[1], 0, 1, 0, 0);
-	m_shaders.at(2) = LoadShader(ctx, shader_files[2], 0, 0, 0, 0);
-	m_shaders.at(3) = LoadShader(ctx, shader_files[3], 2, 1, 0, 0);
-	for (int i = 0; i < 4; ++i) {
+	for (size_t i = 0; i < m_shaders.size(); ++i) {
+		const ShaderDesc &desc { SHADERS[i] };
+		m_shaders.at(i) = LoadShader(ctx, desc.filename, desc.num_samplers, desc.num_uniform_buffers, desc.num_storage_buffers, desc.num_storage_textures);
 		if (m_shaders.at(i) == nullptr) {
 			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "loadShader failed");
 			return false;
 		}
-		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Created GPUShader:\n\t%s", shader_files[i]);
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Created GPUShader:\n\t%s", desc.filename);
+	}
+	return true;
+}
+
+bool SceneMaterial::createPipelines(const ContextData &ctx) {
+	m_world_pipeline = createWorldPipeline(ctx, m_shaders.at(0), m_shaders.at(1), false);
+	m_screen_pipeline = createScreenPipeline(ctx, m_shaders.at(2), m_shaders.at(3));
+	m_skybox_pipeline = createSkyboxPipeline(ctx, m_shaders.at(4), m_shaders.at(5));
+	m_voxel_pipeline = createVoxelPipeline(ctx, m_shaders.at(6), m_shaders.at(7), false);
+	m_world_depth_pipeline = createWorldPipeline(ctx, m_shaders.at(8), m_shaders.at(9), true);
+	m_voxel_depth_pipeline = createVoxelPipeline(ctx, m_shaders.at(10), m_shaders.at(11), true);
+	for (SDL_GPUShader *shader : m_shaders) {
+		SDL_ReleaseGPUShader(ctx.gpu, shader);
 	}
+	if (m_world_pipeline == nullptr || m_screen_pipeline == nullptr || m_skybox_pipeline == nullptr || m_voxel_pipeline == nullptr
+		|| m_world_depth_pipeline == nullptr || m_voxel_depth_pipeline == nullptr) {
+		return false;
+	}
+	// rebuilt off-thread when their sources change, swapped in by draw()
+	m_reloader.watch(&m_world_pipeline, SHADERS[0], SHADERS[1], [this](const ContextData &ctx, SDL_GPUShader *vert, SDL_GPUShader *frag) {
+		return createWorldPipeline(ctx, vert, frag, false);
+	});
+	m_reloader.watch(&m_screen_pipeline, SHADERS[2], SHADERS[3], [this](const ContextData &ctx, SDL_GPUShader *vert, SDL_GPUShader *frag) {
+		return createScreenPipeline(ctx, vert, frag);
+	});
+	m_reloader.watch(&m_skybox_pipeline, SHADERS[4], SHADERS[5], [this](const ContextData &ctx, SDL_GPUShader *vert, SDL_GPUShader *frag) {
+		return createSkyboxPipeline(ctx, vert, frag);
+	});
+	m_reloader.watch(&m_voxel_pipeline, SHADERS[6], SHADERS[7], [this](const ContextData &ctx, SDL_GPUShader *vert, SDL_GPUShader *frag) {
+		return createVoxelPipeline(ctx, vert, frag, false);
+	});
+	m_reloader.watch(&m_world_depth_pipeline, SHADERS[8], SHADERS[9], [this](const ContextData &ctx, SDL_GPUShader *vert, SDL_GPUShader *frag) {
+		return createWorldPipeline(ctx, vert, frag, true);
+	});
+	m_reloader.watch(&m_voxel_depth_pipeline, SHADERS[10], SHADERS[11], [this](const ContextData &ctx, SDL_GPUShader *vert, SDL_GPUShader *frag) {
+		return createVoxelPipeline(ctx, vert, frag, true);
+	});
+	m_lighting.watchShaders(m_reloader);
+	m_hiz.watchShaders(m_reloader);
+	m_reloader.start();
 	return true;
 }
-bool SceneMaterial::createWorldPipeline(const ContextData &ctx) {
+
+SDL_GPUGraphicsPipeline* SceneMaterial::createWorldPipeline(const ContextData &ctx, SDL_GPUShader *vert, SDL_GPUShader *frag, const bool &depth_only) const {
 	const SDL_GPUVertexBufferDescription vertex_buffer_descriptions[1] {
 		{
 			.slot = 0,
@@ -53,9 +108,10 @@ bool SceneMaterial::createWorldPipeline(const ContextData &ctx) {
 	const SDL_GPUColorTargetDescription color_target_descriptions[1] {
 		{ .format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM }
 	};
+	// the depth only variant fills the pre-pass, the lit one then passes on equal depth
 	const SDL_GPUGraphicsPipelineCreateInfo world_pipeline_create {
-		.vertex_shader = m_shaders.at(0),
-		.fragment_shader = m_shaders.at(1),
+		.vertex_shader = vert,
+		.fragment_shader = frag,
 		.vertex_input_state = {
 			.vertex_buffer_descriptions = vertex_buffer_descriptions,
 			.num_vertex_buffers = 1,
@@ -65,11 +121,11 @@ bool SceneMaterial::createWorldPipeline(const ContextData &ctx) {
 		.primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
 		.rasterizer_state = {
 			.fill_mode = SDL_GPU_FILLMODE_FILL,
-			.cull_mode = SDL_GPU_CULLMODE_NONE,
-			.front_face = SDL_GPU_FRONTFACE_COUNTER_CLOCKWISE
+			.cull_mode = SDL_GPU_CULLMODE_BACK,
+			.front_face = SDL_GPU_FRONTFACE_CLOCKWISE // the cube's indices wind clockwise seen from outside
 		},
 		.depth_stencil_state = {
-			.compare_op = SDL_GPU_COMPAREOP_LESS,
+			.compare_op = depth_only ? SDL_GPU_COMPAREOP_GREATER : SDL_GPU_COMPAREOP_GREATER_OR_EQUAL,
 			.write_mask = 0xFF,
 			.enable_depth_test = true,
 			.enable_depth_write = true,
@@ -77,23 +133,21 @@ bool SceneMaterial::createWorldPipeline(const ContextData &ctx) {
 		},
 		.target_info = {
 			.color_target_descriptions = color_target_descriptions,
-			.num_color_targets = 1,
-			.depth_stencil_format = SDL_GPU_TEXTUREFORMAT_D16_UNORM,
+			.num_color_targets = depth_only ? 0u : 1u,
+			.depth_stencil_format = DEPTH_FORMAT,
 			.has_depth_stencil_target = true
 		}
 	};
-	m_world_pipeline = SDL_CreateGPUGraphicsPipeline(ctx.gpu, &world_pipeline_create);
-	if (m_world_pipeline == nullptr) {
+	SDL_GPUGraphicsPipeline *pipeline { SDL_CreateGPUGraphicsPipeline(ctx.gpu, &world_pipeline_create) };
+	if (pipeline == nullptr) {
 		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateGPUGraphicsPipeline failed: %s", SDL_GetError());
-		return false;
+		return nullptr;
 	}
 	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Created GPUGraphicsPipeline");
-	SDL_ReleaseGPUShader(ctx.gpu, m_shaders.at(0));
-	SDL_ReleaseGPUShader(ctx.gpu, m_shaders.at(1));
-	return true;
+	return pipeline;
 }
 
-bool SceneMaterial::createScreenPipeline(const ContextData &ctx) {
+SDL_GPUGraphicsPipeline* SceneMaterial::createScreenPipeline(const ContextData &ctx, SDL_GPUShader *vert, SDL_GPUShader *frag) const {
 	const SDL_GPUVertexBufferDescription vertex_buffer_descriptions[1] {
 		{
 			.slot = 0,
@@ -128,8 +182,8 @@ bool SceneMaterial::createScreenPipeline(const ContextData &ctx) {
 		}
 	}};
 	const SDL_GPUGraphicsPipelineCreateInfo screen_pipeline_create {
-		.vertex_shader = m_shaders.at(2), // assigned during .init()
-		.fragment_shader = m_shaders.at(3), // assigned during .init()
+		.vertex_shader = vert,
+		.fragment_shader = frag,
 		.vertex_input_state = {
 			.vertex_buffer_descriptions = vertex_buffer_descriptions,
 			.num_vertex_buffers = 1,
@@ -142,15 +196,144 @@ bool SceneMaterial::createScreenPipeline(const ContextData &ctx) {
 			.num_color_targets = 1,
 		},
 	};
-	m_screen_pipeline = SDL_CreateGPUGraphicsPipeline(ctx.gpu, &screen_pipeline_create);
-	if (m_screen_pipeline == nullptr) {
+	SDL_GPUGraphicsPipeline *pipeline { SDL_CreateGPUGraphicsPipeline(ctx.gpu, &screen_pipeline_create) };
+	if (pipeline == nullptr) {
 		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateGPUGraphicsPipeline failed: %s", SDL_GetError());
-		return false;
+		return nullptr;
 	}
 	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Created GPUGraphicsPipeline");
-	SDL_ReleaseGPUShader(ctx.gpu, m_shaders.at(2));
-	SDL_ReleaseGPUShader(ctx.gpu, m_shaders.at(3));
-	return true;
+	return pipeline;
+}
+
+SDL_GPUGraphicsPipeline* SceneMaterial::createSkyboxPipeline(const ContextData &ctx, SDL_GPUShader *vert, SDL_GPUShader *frag) const {
+	const SDL_GPUVertexBufferDescription vertex_buffer_descriptions[1] {
+		{
+			.slot = 0,
+			.pitch = sizeof(PositionVertex),
+			.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX,
+			.instance_step_rate = 0
+		}
+	};
+	const SDL_GPUVertexAttribute vertex_attributes[1] {
+		{
+			.location = 0,
+			.buffer_slot = 0,
+			.format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3,
+			.offset = 0
+		}
+	};
+	const SDL_GPUColorTargetDescription color_target_descriptions[1] {
+		{ .format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM }
+	};
+	// drawn last in the world pass at the far plane, the EQUAL test against the cleared depth shades only uncovered pixels
+	const SDL_GPUGraphicsPipelineCreateInfo skybox_pipeline_create {
+		.vertex_shader = vert,
+		.fragment_shader = frag,
+		.vertex_input_state = {
+			.vertex_buffer_descriptions = vertex_buffer_descriptions,
+			.num_vertex_buffers = 1,
+			.vertex_attributes = vertex_attributes,
+			.num_vertex_attributes = 1,
+		},
+		.primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
+		.rasterizer_state = {
+			.fill_mode = SDL_GPU_FILLMODE_FILL,
+			.cull_mode = SDL_GPU_CULLMODE_NONE,
+			.front_face = SDL_GPU_FRONTFACE_COUNTER_CLOCKWISE
+		},
+		.depth_stencil_state = {
+			.compare_op = SDL_GPU_COMPAREOP_EQUAL,
+			.enable_depth_test = true,
+			.enable_depth_write = false,
+			.enable_stencil_test = false,
+		},
+		.target_info = {
+			.color_target_descriptions = color_target_descriptions,
+			.num_color_targets = 1,
+			.depth_stencil_format = DEPTH_FORMAT,
+			.has_depth_stencil_target = true
+		}
+	};
+	SDL_GPUGraphicsPipeline *pipeline { SDL_CreateGPUGraphicsPipeline(ctx.gpu, &skybox_pipeline_create) };
+	if (pipeline == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateGPUGraphicsPipeline failed: %s", SDL_GetError());
+		return nullptr;
+	}
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Created GPUGraphicsPipeline");
+	return pipeline;
+}
+
+SDL_GPUGraphicsPipeline* SceneMaterial::createVoxelPipeline(const ContextData &ctx, SDL_GPUShader *vert, SDL_GPUShader *frag, const bool &depth_only) const {
+	const SDL_GPUVertexBufferDescription vertex_buffer_descriptions[2] {
+		{
+			.slot = 0,
+			.pitch = sizeof(VoxelVertex),
+			.input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX,
+			.instance_step_rate = 0
+		}, {
+			.slot = 1,
+			.pitch = sizeof(VoxelInstance),
+			.input_rate = SDL_GPU_VERTEXINPUTRATE_INSTANCE,
+			.instance_step_rate = 0
+		}
+	};
+	const SDL_GPUVertexAttribute vertex_attributes[3] {
+		{
+			.location = 0,
+			.buffer_slot = 0,
+			.format = SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4,
+			.offset = 0
+		}, {
+			.location = 1,
+			.buffer_slot = 0,
+			.format = SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4_NORM,
+			.offset = sizeof(Uint8) * 4
+		}, {
+			.location = 2,
+			.buffer_slot = 1,
+			.format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4,
+			.offset = 0
+		}
+	};
+	const SDL_GPUColorTargetDescription color_target_descriptions[1] {
+		{ .format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM }
+	};
+	const SDL_GPUGraphicsPipelineCreateInfo voxel_pipeline_create {
+		.vertex_shader = vert,
+		.fragment_shader = frag,
+		.vertex_input_state = {
+			.vertex_buffer_descriptions = vertex_buffer_descriptions,
+			.num_vertex_buffers = 2,
+			.vertex_attributes = vertex_attributes,
+			.num_vertex_attributes = 3,
+		},
+		.primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
+		.rasterizer_state = {
+			.fill_mode = SDL_GPU_FILLMODE_FILL,
+			.cull_mode = SDL_GPU_CULLMODE_BACK,
+			.front_face = SDL_GPU_FRONTFACE_COUNTER_CLOCKWISE
+		},
+		.depth_stencil_state = {
+			.compare_op = depth_only ? SDL_GPU_COMPAREOP_GREATER : SDL_GPU_COMPAREOP_GREATER_OR_EQUAL,
+			.write_mask = 0xFF,
+			.enable_depth_test = true,
+			.enable_depth_write = true,
+			.enable_stencil_test = false,
+		},
+		.target_info = {
+			.color_target_descriptions = color_target_descriptions,
+			.num_color_targets = depth_only ? 0u : 1u,
+			.depth_stencil_format = DEPTH_FORMAT,
+			.has_depth_stencil_target = true
+		}
+	};
+	SDL_GPUGraphicsPipeline *pipeline { SDL_CreateGPUGraphicsPipeline(ctx.gpu, &voxel_pipeline_create) };
+	if (pipeline == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateGPUGraphicsPipeline failed: %s", SDL_GetError());
+		return nullptr;
+	}
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Created GPUGraphicsPipeline");
+	return pipeline;
 }
 
 bool SceneMaterial::createColorTexture(const ContextData &ctx) {
@@ -176,7 +359,7 @@ bool SceneMaterial::createColorTexture(const ContextData &ctx) {
 bool SceneMaterial::createDepthTexture(const ContextData &ctx) {
 	const SDL_GPUTextureCreateInfo scene_depth_create {
 		.type = SDL_GPU_TEXTURETYPE_2D,
-		.format = SDL_GPU_TEXTUREFORMAT_D16_UNORM,
+		.format = DEPTH_FORMAT,
 		.usage = SDL_GPU_TEXTUREUSAGE_SAMPLER | SDL_GPU_TEXTUREUSAGE_DEPTH_STENCIL_TARGET,
 		.width = ctx.width,
 		.height = ctx.height,
@@ -207,6 +390,21 @@ bool SceneMaterial::createSampler(const ContextData &ctx) {
 		return false;
 	}
 	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Created GPUSampler");
+	const SDL_GPUSamplerCreateInfo skybox_sampler_create {
+		.min_filter = SDL_GPU_FILTER_LINEAR,
+		.mag_filter = SDL_GPU_FILTER_LINEAR,
+		.mipmap_mode = SDL_GPU_SAMPLERMIPMAPMODE_LINEAR,
+		.address_mode_u = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+		.address_mode_v = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+		.address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+		.max_lod = 1000.0f
+	};
+	m_skybox_sampler = SDL_CreateGPUSampler(ctx.gpu, &skybox_sampler_create);
+	if (m_skybox_sampler == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateGPUSampler failed: %s", SDL_GetError());
+		return false;
+	}
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Created GPUSampler");
 	return true;
 }
 
@@ -215,10 +413,8 @@ int SceneMaterial::init() {
 	const ContextData ctx { Context::get()->data() };
 	if (!loadShaders(ctx))
 		return -1;
-	else if (!createWorldPipeline(ctx))
+	else if (!createPipelines(ctx))
 		return -2;
-	else if (!createScreenPipeline(ctx))
-		return -3;
 	else if (!createColorTexture(ctx))
 		return -4;
 	else if (!createDepthTexture(ctx))
@@ -267,6 +463,14 @@ int SceneMaterial::init() {
 		{-1, -1, 0, 0, 1}
 	};
 	const Uint16 screen_indices[6] { 0, 1, 2, 0, 2, 3 };
+	const PositionVertex skybox_vertices[24] {
+		{ -10, -10, -10 }, { 10, -10, -10 }, { 10, 10, -10 }, { -10, 10, -10 },
+		{ -10, -10, 10 }, { 10, -10, 10 }, { 10, 10, 10 }, { -10, 10, 10 },
+		{ -10, -10, -10 }, { -10, 10, -10 }, { -10, 10, 10 }, { -10, -10, 10 },
+		{ 10, -10, -10 }, { 10, 10, -10 }, { 10, 10, 10 }, { 10, -10, 10 },
+		{ -10, -10, -10 }, { -10, -10, 10 }, { 10, -10, 10 }, { 10, -10, -10 },
+		{ -10, 10, -10 }, { -10, 10, 10 }, { 10, 10, 10 }, { 10, 10, -10 }
+	};
 	// push verts & indices to buffer
 	SDL_memcpy(m_world_v.open(), world_vertices, sizeof(PositionColorVertex) * 24);
 	m_world_v.upload();
@@ -276,6 +480,17 @@ int SceneMaterial::init() {
 	m_screen_v.upload();
 	SDL_memcpy(m_screen_i.open(), screen_indices, sizeof(Uint16) * 6);
 	m_screen_i.upload();
+	SDL_memcpy(m_skybox_v.open(), skybox_vertices, sizeof(PositionVertex) * 24);
+	m_skybox_v.upload();
+	SDL_memcpy(m_skybox_i.open(), world_indices, sizeof(Uint16) * 36); // same winding as the world cube
+	m_skybox_i.upload();
+	// faces stream in on worker threads, a flat placeholder is drawn until then
+	m_skybox = m_textures.loadCube({
+		"skybox/right.bmp", "skybox/left.bmp",
+		"skybox/top.bmp", "skybox/bottom.bmp",
+		"skybox/front.bmp", "skybox/back.bmp"
+	});
+	m_lighting.scatterLights(64, 1);
 	return 0;
 }
 
@@ -285,16 +500,31 @@ SceneMaterial::~SceneMaterial() {
 	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Released GPUGraphicsPipeline");
 	SDL_ReleaseGPUGraphicsPipeline(ctx.gpu, m_screen_pipeline);
 	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Released GPUGraphicsPipeline");
+	SDL_ReleaseGPUGraphicsPipeline(ctx.gpu, m_skybox_pipeline);
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Released GPUGraphicsPipeline");
+	SDL_ReleaseGPUGraphicsPipeline(ctx.gpu, m_voxel_pipeline);
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Released GPUGraphicsPipeline");
+	SDL_ReleaseGPUGraphicsPipeline(ctx.gpu, m_world_depth_pipeline);
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Released GPUGraphicsPipeline");
+	SDL_ReleaseGPUGraphicsPipeline(ctx.gpu, m_voxel_depth_pipeline);
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Released GPUGraphicsPipeline");
 	SDL_ReleaseGPUTexture(ctx.gpu, m_scene_color);
 	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Released GPUTexture");
 	SDL_ReleaseGPUTexture(ctx.gpu, m_scene_depth);
 	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Released GPUTexture");
 	SDL_ReleaseGPUSampler(ctx.gpu, m_sampler);
 	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Released GPUSampler");
+	SDL_ReleaseGPUSampler(ctx.gpu, m_skybox_sampler);
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Released GPUSampler");
 }
 
 void SceneMaterial::draw() {
 	ContextData ctx { Context::get()->data() };
+	// frame boundary: pick up pipelines rebuilt by the shader reloader
+	m_reloader.swap();
+	m_frame_arena.reset();
+	// occlusion data from the newest readback that has landed, usually last frame's
+	m_hiz.fetch(ctx.camera_pos);
 	SDL_GPUCommandBuffer *cmdbuf { SDL_AcquireGPUCommandBuffer(ctx.gpu) };
 	SDL_GPUTexture *swapchain;
 	if (!SDL_WaitAndAcquireGPUSwapchainTexture(cmdbuf, ctx.window, &swapchain, NULL, NULL)) {
@@ -302,11 +532,50 @@ void SceneMaterial::draw() {
 		return;
 	}
 	// do projection math
-	float near_far[2] {0.01f, 100.0f};
+	FrameUniforms *frame { m_frame_arena.local().create<FrameUniforms>() };
+	frame->near_far[0] = 0.01f;
+	frame->near_far[1] = 100.0f;
+	const float fov { 75.0f * SDL_PI_F / 180.0f };
 	float aspect { static_cast<float>(ctx.width) / static_cast<float>(ctx.height) };
-	Matrix4x4 proj { CreateProjection(75.0f * SDL_PI_F / 180.0f, aspect, near_far[0], near_far[1]) };
+	Matrix4x4 proj { CreateProjection(fov, aspect, frame->near_far[0], frame->near_far[1]) };
 	Matrix4x4 view { CreateView(ctx.camera_pos, {0, 0, 0}, {0, 1, 0}) };
-	Matrix4x4 view_proj { view * proj };
+	frame->view_proj = view * proj;
+	Matrix4x4 sky_view { view };
+	sky_view.at(3) = Vector4 { 0, 0, 0, 1 }; // skybox follows the camera
+	frame->sky_view_proj = sky_view * proj;
+	frame->lighting = m_lighting.uniforms(view, fov, aspect, frame->near_far);
+	// batched texture uploads & mip generation, recorded ahead of the passes that sample them
+	m_textures.update(cmdbuf);
+	// stream chunks around the camera & upload finished meshes
+	m_voxels.update(cmdbuf, ctx.camera_pos);
+	// assign lights to clusters for the lit pipelines
+	m_lighting.cull(cmdbuf, frame->lighting);
+	// skip chunks hidden behind the fetched Hi-Z, upload the origins of the rest
+	m_voxels.cull(cmdbuf, m_hiz);
+	const SDL_GPUBufferBinding world_buffer_binding_v { m_world_v.get(), 0 };
+	const SDL_GPUBufferBinding world_buffer_binding_i { m_world_i.get(), 0 };
+	// depth only pre-pass, so the lit pass shades every pixel once
+	if (m_depth_prepass) {
+		const SDL_GPUDepthStencilTargetInfo prepass_target_info {
+			.texture = m_scene_depth,
+			.clear_depth = 0,
+			.load_op = SDL_GPU_LOADOP_CLEAR,
+			.store_op = SDL_GPU_STOREOP_STORE,
+			.stencil_load_op = SDL_GPU_LOADOP_CLEAR,
+			.stencil_store_op = SDL_GPU_STOREOP_STORE,
+			.cycle = true,
+			.clear_stencil = 0,
+		};
+		SDL_GPURenderPass *prepass { SDL_BeginGPURenderPass(cmdbuf, NULL, 0, &prepass_target_info) };
+		SDL_PushGPUVertexUniformData(cmdbuf, 0, &frame->view_proj, sizeof(frame->view_proj));
+		SDL_BindGPUGraphicsPipeline(prepass, m_world_depth_pipeline);
+		SDL_BindGPUVertexBuffers(prepass, 0, &world_buffer_binding_v, 1);
+		SDL_BindGPUIndexBuffer(prepass, &world_buffer_binding_i, SDL_GPU_INDEXELEMENTSIZE_16BIT);
+		SDL_DrawGPUIndexedPrimitives(prepass, m_world_i.getCount(), 1, 0, 0, 0);
+		SDL_BindGPUGraphicsPipeline(prepass, m_voxel_depth_pipeline);
+		m_voxels.draw(prepass, cmdbuf, frame->view_proj);
+		SDL_EndGPURenderPass(prepass);
+	}
 	// setup target info
 	const SDL_GPUColorTargetInfo world_color_target_info {
 		.texture = m_scene_color,
@@ -316,25 +585,39 @@ void SceneMaterial::draw() {
 	};
 	const SDL_GPUDepthStencilTargetInfo depth_stencil_target_info {
 		.texture = m_scene_depth,
-		.clear_depth = 1,
-		.load_op = SDL_GPU_LOADOP_CLEAR,
+		.clear_depth = 0,
+		.load_op = m_depth_prepass ? SDL_GPU_LOADOP_LOAD : SDL_GPU_LOADOP_CLEAR,
 		.store_op = SDL_GPU_STOREOP_STORE,
 		.stencil_load_op = SDL_GPU_LOADOP_CLEAR,
 		.stencil_store_op = SDL_GPU_STOREOP_STORE,
-		.cycle = true,
+		.cycle = !m_depth_prepass,
 		.clear_stencil = 0,
 	};
-	SDL_PushGPUVertexUniformData(cmdbuf, 0, &view_proj, sizeof(view_proj));
-	SDL_PushGPUFragmentUniformData(cmdbuf, 0, near_far, sizeof(near_far));
+	SDL_PushGPUFragmentUniformData(cmdbuf, 0, &frame->lighting, sizeof(frame->lighting));
 	// render to screen texture
 	SDL_GPURenderPass *render_pass { SDL_BeginGPURenderPass(cmdbuf, &world_color_target_info, 1, &depth_stencil_target_info)};
-	const SDL_GPUBufferBinding world_buffer_binding_v { m_world_v.get(), 0 };
-	const SDL_GPUBufferBinding world_buffer_binding_i { m_world_i.get(), 0 };
+	SDL_PushGPUVertexUniformData(cmdbuf, 0, &frame->view_proj, sizeof(frame->view_proj));
 	SDL_BindGPUVertexBuffers(render_pass, 0, &world_buffer_binding_v, 1);
 	SDL_BindGPUIndexBuffer(render_pass, &world_buffer_binding_i, SDL_GPU_INDEXELEMENTSIZE_16BIT);
 	SDL_BindGPUGraphicsPipeline(render_pass, m_world_pipeline);
+	m_lighting.bind(render_pass);
 	SDL_DrawGPUIndexedPrimitives(render_pass, m_world_i.getCount(), 1, 0, 0, 0);
+	SDL_BindGPUGraphicsPipeline(render_pass, m_voxel_pipeline);
+	m_lighting.bind(render_pass);
+	m_voxels.draw(render_pass, cmdbuf, frame->view_proj);
+	// sky last, so it only fills the pixels the scene left at the cleared depth
+	const SDL_GPUBufferBinding skybox_buffer_binding_v { m_skybox_v.get(), 0 };
+	const SDL_GPUBufferBinding skybox_buffer_binding_i { m_skybox_i.get(), 0 };
+	const SDL_GPUTextureSamplerBinding skybox_sampler_binding { m_textures.get(m_skybox), m_skybox_sampler };
+	SDL_BindGPUGraphicsPipeline(render_pass, m_skybox_pipeline);
+	SDL_BindGPUVertexBuffers(render_pass, 0, &skybox_buffer_binding_v, 1);
+	SDL_BindGPUIndexBuffer(render_pass, &skybox_buffer_binding_i, SDL_GPU_INDEXELEMENTSIZE_16BIT);
+	SDL_BindGPUFragmentSamplers(render_pass, 0, &skybox_sampler_binding, 1);
+	SDL_PushGPUVertexUniformData(cmdbuf, 0, &frame->sky_view_proj, sizeof(frame->sky_view_proj));
+	SDL_DrawGPUIndexedPrimitives(render_pass, m_skybox_i.getCount(), 1, 0, 0, 0);
 	SDL_EndGPURenderPass(render_pass);
+	// farthest depth pyramid for next frames' occlusion tests
+	m_hiz.build(cmdbuf, m_scene_depth, frame->view_proj, frame->near_far, ctx.camera_pos);
 	// render post processing
 	const SDL_GPUColorTargetInfo screen_color_target_info {
 		.texture = swapchain,
@@ -354,18 +637,26 @@ void SceneMaterial::draw() {
 		{m_scene_depth, m_sampler}
 	};
 	SDL_BindGPUFragmentSamplers(render_pass, 0, texture_sampler_bindings, 2);
+	SDL_PushGPUFragmentUniformData(cmdbuf, 0, frame->near_far, sizeof(frame->near_far));
 	SDL_DrawGPUIndexedPrimitives(render_pass, m_screen_i.getCount(), 1, 0, 0, 0);
 	SDL_EndGPURenderPass(render_pass);
-	SDL_SubmitGPUCommandBuffer(cmdbuf);
+	m_hiz.submit(cmdbuf);
+	m_hiz.report(m_depth_prepass);
+}
+
+void SceneMaterial::finish() {
+	const ContextData ctx { Context::get()->data() };
+	SDL_WaitForGPUIdle(ctx.gpu);
 }
 
+// reverse-Z: the near plane maps to depth 1 & the far plane to 0, which spreads float precision evenly over distance
 Matrix4x4 CreateProjection(const float &fov, const float &aspect, const float &near, const float &far) {
 	const float num { 1.0f / static_cast<float>(SDL_tanf(fov * 0.5f)) };
 	return Matrix4x4 {
 		Vector4 { num / aspect, 0, 0, 0 },
 		Vector4 { 0, num, 0, 0 },
-		Vector4 { 0, 0, far / (near - far), -1 },
-		Vector4 { 0, 0, (near * far) / (near - far), 0 },
+		Vector4 { 0, 0, near / (far - near), -1 },
+		Vector4 { 0, 0, (near * far) / (far - near), 0 },
 	};
 }
 
@@ -422,9 +713,39 @@ SDL_GPUShader* LoadShader(const ContextData &ctx, const char *filename, const Ui
 		.num_uniform_buffers = num_uniform_buffers
 	};
 	SDL_GPUShader *result { SDL_ShaderCross_CompileGraphicsShaderFromHLSL(ctx.gpu, &shader_info, &metadata) };
+	SDL_free(code);
 	if (result == nullptr) {
 		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CompileGraphicsShaderFromHLSL failed: %s", SDL_GetError());
 		return nullptr;
 	}
 	return result;
 }
+
+SDL_GPUComputePipeline* LoadComputePipeline(const ContextData &ctx, const char *filename, const SDL_ShaderCross_ComputePipelineMetadata &metadata) {
+	char full_path[256];
+	SDL_snprintf(full_path, sizeof(full_path), "%s%s%s%s", ctx.exe_path, ctx.shaders_path, filename, ".hlsl");
+	size_t code_size;
+	void *code { SDL_LoadFile(full_path, &code_size) };
+	if (code == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "LoadFile failed: %s", SDL_GetError());
+		return nullptr;
+	}
+	SDL_ShaderCross_HLSL_Info shader_info {
+		.source = static_cast<const char*>(code),
+		.entrypoint = "main",
+		.include_dir = NULL,
+		.defines = NULL,
+		.shader_stage = SDL_SHADERCROSS_SHADERSTAGE_COMPUTE,
+		.enable_debug = true,
+		.name = NULL,
+		.props = 0
+	};
+	SDL_GPUComputePipeline *result { SDL_ShaderCross_CompileComputePipelineFromHLSL(ctx.gpu, &shader_info, &metadata) };
+	SDL_free(code);
+	if (result == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CompileComputePipelineFromHLSL failed: %s", SDL_GetError());
+		return nullptr;
+	}
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Created GPUComputePipeline:\n\t%s", filename);
+	return result;
+}
@@ -32,6 +32,7 @@ Renderer::Renderer(const int &t_width, const int &t_height) : m_width(t_width),
 		mutual_format,
 		SDL_GetBasePath(),
 		"shaders/source/",
+		"textures/",
 		{30, 30, 30}
 	};
 	Context::get()->set(ctx);
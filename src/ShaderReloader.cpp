@@ -0,0 +1,167 @@
+#include "ShaderReloader.hpp"
+#include "Materials.hpp"
+#include "SDL3/SDL_log.h"
+#include "SDL3/SDL_timer.h"
+
+ShaderReloader::~ShaderReloader() {
+	if (m_thread != nullptr) {
+		SDL_SetAtomicInt(&m_quit, 1);
+		SDL_LockMutex(m_lock);
+		SDL_SignalCondition(m_cond);
+		SDL_UnlockMutex(m_lock);
+		SDL_WaitThread(m_thread, NULL);
+	}
+	// rebuilt but never swapped in
+	for (Ready &ready : m_ready) {
+		SDL_ReleaseGPUGraphicsPipeline(m_ctx.gpu, ready.replacement);
+	}
+	for (ReadyCompute &ready : m_ready_compute) {
+		SDL_ReleaseGPUComputePipeline(m_ctx.gpu, ready.replacement);
+	}
+	SDL_DestroyCondition(m_cond);
+	SDL_DestroyMutex(m_lock);
+}
+
+void ShaderReloader::watch(SDL_GPUGraphicsPipeline **pipeline, const ShaderDesc &vert, const ShaderDesc &frag, PipelineBuilder builder) {
+	m_watched.push_back(Watched { pipeline, vert, frag, std::move(builder) });
+}
+
+void ShaderReloader::watch(SDL_GPUComputePipeline **pipeline, const char *filename, const SDL_ShaderCross_ComputePipelineMetadata &metadata) {
+	m_watched_compute.push_back(WatchedCompute { pipeline, filename, metadata });
+}
+
+bool ShaderReloader::start() {
+	m_ctx = Context::get()->data();
+	for (Watched &watched : m_watched) {
+		watched.modified[0] = modifiedTime(m_ctx, watched.vert.filename);
+		watched.modified[1] = modifiedTime(m_ctx, watched.frag.filename);
+	}
+	for (WatchedCompute &watched : m_watched_compute) {
+		watched.modified = modifiedTime(m_ctx, watched.filename);
+	}
+	m_lock = SDL_CreateMutex();
+	m_cond = SDL_CreateCondition();
+	if (m_lock == nullptr || m_cond == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateMutex failed: %s", SDL_GetError());
+		return false;
+	}
+	m_thread = SDL_CreateThread(worker, "ShaderReloader", this);
+	if (m_thread == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateThread failed: %s", SDL_GetError());
+		return false;
+	}
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Watching %s%s for changes", m_ctx.exe_path, m_ctx.shaders_path);
+	return true;
+}
+
+void ShaderReloader::requestAll() {
+	if (m_thread == nullptr) {
+		return;
+	}
+	SDL_SetAtomicInt(&m_force, 1);
+	SDL_LockMutex(m_lock);
+	SDL_SignalCondition(m_cond);
+	SDL_UnlockMutex(m_lock);
+}
+
+int ShaderReloader::worker(void *data) {
+	ShaderReloader *self { static_cast<ShaderReloader*>(data) };
+	while (SDL_GetAtomicInt(&self->m_quit) == 0) {
+		SDL_LockMutex(self->m_lock);
+		SDL_WaitConditionTimeout(self->m_cond, self->m_lock, POLL_INTERVAL_MS);
+		SDL_UnlockMutex(self->m_lock);
+		if (SDL_GetAtomicInt(&self->m_quit) != 0) {
+			break;
+		}
+		const bool force { SDL_SetAtomicInt(&self->m_force, 0) != 0 };
+		self->poll(self->m_ctx, force);
+		self->pollCompute(self->m_ctx, force);
+	}
+	return 0;
+}
+
+SDL_Time ShaderReloader::modifiedTime(const ContextData &ctx, const char *filename) const {
+	char full_path[256];
+	SDL_snprintf(full_path, sizeof(full_path), "%s%s%s%s", ctx.exe_path, ctx.shaders_path, filename, ".hlsl");
+	SDL_PathInfo info;
+	if (!SDL_GetPathInfo(full_path, &info)) {
+		return 0;
+	}
+	return info.modify_time;
+}
+
+void ShaderReloader::poll(const ContextData &ctx, const bool &force) {
+	for (Watched &watched : m_watched) {
+		const SDL_Time modified[2] { modifiedTime(ctx, watched.vert.filename), modifiedTime(ctx, watched.frag.filename) };
+		if (!force && modified[0] == watched.modified[0] && modified[1] == watched.modified[1]) {
+			continue;
+		}
+		// don't retry a broken source until it is saved again
+		watched.modified[0] = modified[0];
+		watched.modified[1] = modified[1];
+		const Uint64 detected_ns { SDL_GetTicksNS() };
+		SDL_GPUShader *vert { LoadShader(ctx, watched.vert.filename, watched.vert.num_samplers, watched.vert.num_uniform_buffers, watched.vert.num_storage_buffers, watched.vert.num_storage_textures) };
+		SDL_GPUShader *frag { LoadShader(ctx, watched.frag.filename, watched.frag.num_samplers, watched.frag.num_uniform_buffers, watched.frag.num_storage_buffers, watched.frag.num_storage_textures) };
+		SDL_GPUGraphicsPipeline *replacement { nullptr };
+		if (vert != nullptr && frag != nullptr) {
+			replacement = watched.builder(ctx, vert, frag);
+		}
+		SDL_ReleaseGPUShader(ctx.gpu, vert);
+		SDL_ReleaseGPUShader(ctx.gpu, frag);
+		if (replacement == nullptr) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Reload failed, keeping previous pipeline:\n\t%s\n\t%s", watched.vert.filename, watched.frag.filename);
+			continue;
+		}
+		SDL_LockMutex(m_lock);
+		m_ready.push_back(Ready { watched.pipeline, replacement, watched.frag.filename, detected_ns, SDL_GetTicksNS() });
+		SDL_UnlockMutex(m_lock);
+	}
+}
+
+void ShaderReloader::pollCompute(const ContextData &ctx, const bool &force) {
+	for (WatchedCompute &watched : m_watched_compute) {
+		const SDL_Time modified { modifiedTime(ctx, watched.filename) };
+		if (!force && modified == watched.modified) {
+			continue;
+		}
+		watched.modified = modified;
+		const Uint64 detected_ns { SDL_GetTicksNS() };
+		SDL_GPUComputePipeline *replacement { LoadComputePipeline(ctx, watched.filename, watched.metadata) };
+		if (replacement == nullptr) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Reload failed, keeping previous pipeline:\n\t%s", watched.filename);
+			continue;
+		}
+		SDL_LockMutex(m_lock);
+		m_ready_compute.push_back(ReadyCompute { watched.pipeline, replacement, watched.filename, detected_ns, SDL_GetTicksNS() });
+		SDL_UnlockMutex(m_lock);
+	}
+}
+
+void ShaderReloader::swap() {
+	if (m_thread == nullptr) {
+		return;
+	}
+	SDL_LockMutex(m_lock);
+	for (Ready &ready : m_ready) {
+		// in-flight command buffers keep the old pipeline alive until they complete
+		SDL_ReleaseGPUGraphicsPipeline(m_ctx.gpu, *ready.pipeline);
+		*ready.pipeline = ready.replacement;
+		const Uint64 swapped_ns { SDL_GetTicksNS() };
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Reloaded GPUGraphicsPipeline (%s):\n\tBuild: %.2f ms\n\tLatency: %.2f ms",
+			ready.name,
+			(ready.built_ns - ready.detected_ns) / 1e6,
+			(swapped_ns - ready.detected_ns) / 1e6);
+	}
+	m_ready.clear();
+	for (ReadyCompute &ready : m_ready_compute) {
+		SDL_ReleaseGPUComputePipeline(m_ctx.gpu, *ready.pipeline);
+		*ready.pipeline = ready.replacement;
+		const Uint64 swapped_ns { SDL_GetTicksNS() };
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Reloaded GPUComputePipeline (%s):\n\tBuild: %.2f ms\n\tLatency: %.2f ms",
+			ready.name,
+			(ready.built_ns - ready.detected_ns) / 1e6,
+			(swapped_ns - ready.detected_ns) / 1e6);
+	}
+	m_ready_compute.clear();
+	SDL_UnlockMutex(m_lock);
+}
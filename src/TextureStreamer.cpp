@@ -0,0 +1,527 @@
+#include "TextureStreamer.hpp"
+#include "SDL3/SDL_log.h"
+
+namespace {
+	constexpr Uint32 BYTES_PER_PIXEL { 4 };
+
+	Uint32 MipCount(const Uint32 &width, const Uint32 &height) {
+		Uint32 levels { 1 };
+		for (Uint32 size { SDL_max(width, height) }; size > 1; size >>= 1) {
+			++levels;
+		}
+		return levels;
+	}
+
+	Uint64 TextureBytes(const Uint32 &width, const Uint32 &height, const Uint32 &layers) {
+		Uint64 bytes { };
+		const Uint32 levels { MipCount(width, height) };
+		for (Uint32 i = 0; i < levels; ++i) {
+			bytes += static_cast<Uint64>(SDL_max(width >> i, 1u)) * SDL_max(height >> i, 1u) * BYTES_PER_PIXEL;
+		}
+		return bytes * layers;
+	}
+}
+
+TextureStreamer::TextureStreamer(const Uint64 &t_budget, const Uint32 &t_upload_per_frame, const int &t_worker_count)
+	: m_budget(t_budget), m_upload_per_frame(t_upload_per_frame) {
+	const ContextData ctx { Context::get()->data() };
+	m_jobs_lock = SDL_CreateMutex();
+	m_jobs_cond = SDL_CreateCondition();
+	m_decoded_lock = SDL_CreateMutex();
+	if (m_jobs_lock == nullptr || m_jobs_cond == nullptr || m_decoded_lock == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateMutex failed: %s", SDL_GetError());
+		return;
+	}
+	for (int i = 0; i < t_worker_count; ++i) {
+		SDL_Thread *thread { SDL_CreateThread(worker, "TextureStreamer", this) };
+		if (thread == nullptr) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateThread failed: %s", SDL_GetError());
+			continue;
+		}
+		m_workers.push_back(thread);
+	}
+	createFallbacks(ctx);
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Created TextureStreamer:\n\tWorkers: %zu\n\tBudget: %llu bytes", m_workers.size(), static_cast<unsigned long long>(m_budget));
+}
+
+TextureStreamer::~TextureStreamer() {
+	const ContextData ctx { Context::get()->data() };
+	SDL_SetAtomicInt(&m_quit, 1);
+	SDL_LockMutex(m_jobs_lock);
+	SDL_BroadcastCondition(m_jobs_cond);
+	SDL_UnlockMutex(m_jobs_lock);
+	for (SDL_Thread *thread : m_workers) {
+		SDL_WaitThread(thread, NULL);
+	}
+	for (Decoded &decoded : m_decoded) {
+		for (SDL_Surface *face : decoded.faces) {
+			SDL_DestroySurface(face);
+		}
+	}
+	for (Entry &entry : m_entries) {
+		SDL_ReleaseGPUTexture(ctx.gpu, entry.texture);
+		SDL_ReleaseGPUTexture(ctx.gpu, entry.tail);
+	}
+	SDL_ReleaseGPUTexture(ctx.gpu, m_fallback_2d);
+	SDL_ReleaseGPUTexture(ctx.gpu, m_fallback_cube);
+	SDL_DestroyMutex(m_decoded_lock);
+	SDL_DestroyCondition(m_jobs_cond);
+	SDL_DestroyMutex(m_jobs_lock);
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Released TextureStreamer");
+}
+
+bool TextureStreamer::createFallbacks(const ContextData &ctx) {
+	SDL_GPUTextureCreateInfo fallback_create {
+		.type = SDL_GPU_TEXTURETYPE_2D,
+		.format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM,
+		.usage = SDL_GPU_TEXTUREUSAGE_SAMPLER,
+		.width = 1,
+		.height = 1,
+		.layer_count_or_depth = 1,
+		.num_levels = 1,
+		.sample_count = SDL_GPU_SAMPLECOUNT_1
+	};
+	m_fallback_2d = SDL_CreateGPUTexture(ctx.gpu, &fallback_create);
+	fallback_create.type = SDL_GPU_TEXTURETYPE_CUBE;
+	fallback_create.layer_count_or_depth = 6;
+	m_fallback_cube = SDL_CreateGPUTexture(ctx.gpu, &fallback_create);
+	if (m_fallback_2d == nullptr || m_fallback_cube == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateGPUTexture failed: %s", SDL_GetError());
+		return false;
+	}
+	const SDL_GPUTransferBufferCreateInfo trans_buff_info {
+		.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+		.size = BYTES_PER_PIXEL * 7
+	};
+	SDL_GPUTransferBuffer *transfer_buffer { SDL_CreateGPUTransferBuffer(ctx.gpu, &trans_buff_info) };
+	if (transfer_buffer == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateGPUTransferBuffer failed: %s", SDL_GetError());
+		return false;
+	}
+	Uint8 *transfer_data { static_cast<Uint8*>(SDL_MapGPUTransferBuffer(ctx.gpu, transfer_buffer, false)) };
+	if (transfer_data == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "MapGPUTransferBuffer failed: %s", SDL_GetError());
+		SDL_ReleaseGPUTransferBuffer(ctx.gpu, transfer_buffer);
+		return false;
+	}
+	// mid grey, opaque
+	for (Uint32 i = 0; i < BYTES_PER_PIXEL * 7; ++i) {
+		transfer_data[i] = i % BYTES_PER_PIXEL == 3 ? 255 : 128;
+	}
+	SDL_UnmapGPUTransferBuffer(ctx.gpu, transfer_buffer);
+	SDL_GPUCommandBuffer *upload_cmd_buf { SDL_AcquireGPUCommandBuffer(ctx.gpu) };
+	SDL_GPUCopyPass *copy_pass { SDL_BeginGPUCopyPass(upload_cmd_buf) };
+	for (Uint32 layer = 0; layer < 7; ++layer) {
+		const SDL_GPUTextureTransferInfo transfer_info {
+			.transfer_buffer = transfer_buffer,
+			.offset = layer * BYTES_PER_PIXEL
+		};
+		const SDL_GPUTextureRegion region {
+			.texture = layer == 0 ? m_fallback_2d : m_fallback_cube,
+			.layer = layer == 0 ? 0 : layer - 1,
+			.w = 1,
+			.h = 1,
+			.d = 1
+		};
+		SDL_UploadToGPUTexture(copy_pass, &transfer_info, &region, false);
+	}
+	SDL_EndGPUCopyPass(copy_pass);
+	SDL_SubmitGPUCommandBuffer(upload_cmd_buf);
+	SDL_ReleaseGPUTransferBuffer(ctx.gpu, transfer_buffer);
+	return true;
+}
+
+TextureHandle TextureStreamer::load2D(const char *filename) {
+	const ContextData ctx { Context::get()->data() };
+	std::vector<std::string> paths { std::string(ctx.exe_path) + ctx.textures_path + filename };
+	return request(std::move(paths), SDL_GPU_TEXTURETYPE_2D);
+}
+
+TextureHandle TextureStreamer::loadCube(const std::array<const char*, 6> &filenames) {
+	const ContextData ctx { Context::get()->data() };
+	std::vector<std::string> paths;
+	for (const char *filename : filenames) {
+		paths.push_back(std::string(ctx.exe_path) + ctx.textures_path + filename);
+	}
+	return request(std::move(paths), SDL_GPU_TEXTURETYPE_CUBE);
+}
+
+TextureHandle TextureStreamer::request(std::vector<std::string> &&paths, const SDL_GPUTextureType &type) {
+	const TextureHandle handle { static_cast<TextureHandle>(m_entries.size()) };
+	m_entries.push_back(Entry { .paths = std::move(paths), .type = type });
+	enqueue(handle);
+	return handle;
+}
+
+void TextureStreamer::enqueue(const TextureHandle &handle) {
+	Entry &entry { m_entries.at(handle) };
+	entry.pending = true;
+	SDL_LockMutex(m_jobs_lock);
+	m_jobs.push_back(Job { handle, entry.paths, entry.skip_levels });
+	SDL_SignalCondition(m_jobs_cond);
+	SDL_UnlockMutex(m_jobs_lock);
+}
+
+int TextureStreamer::worker(void *data) {
+	TextureStreamer *self { static_cast<TextureStreamer*>(data) };
+	while (true) {
+		SDL_LockMutex(self->m_jobs_lock);
+		while (self->m_jobs.empty() && SDL_GetAtomicInt(&self->m_quit) == 0) {
+			SDL_WaitCondition(self->m_jobs_cond, self->m_jobs_lock);
+		}
+		if (SDL_GetAtomicInt(&self->m_quit) != 0) {
+			SDL_UnlockMutex(self->m_jobs_lock);
+			return 0;
+		}
+		const Job job { std::move(self->m_jobs.front()) };
+		self->m_jobs.pop_front();
+		SDL_UnlockMutex(self->m_jobs_lock);
+		self->decode(job);
+	}
+}
+
+void TextureStreamer::decode(const Job &job) {
+	Decoded result { job.handle, {}, job.skip_levels };
+	for (const std::string &path : job.paths) {
+		SDL_Surface *loaded { SDL_LoadBMP(path.c_str()) };
+		if (loaded == nullptr) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "LoadBMP failed: %s", SDL_GetError());
+			break;
+		}
+		SDL_Surface *face { SDL_ConvertSurface(loaded, SDL_PIXELFORMAT_RGBA32) };
+		SDL_DestroySurface(loaded);
+		// drop the top mip levels when the full resolution did not fit the budget
+		for (Uint32 i = 0; face != nullptr && i < job.skip_levels; ++i) {
+			SDL_Surface *scaled { SDL_ScaleSurface(face, SDL_max(face->w / 2, 1), SDL_max(face->h / 2, 1), SDL_SCALEMODE_LINEAR) };
+			SDL_DestroySurface(face);
+			face = scaled;
+		}
+		if (face == nullptr) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "ConvertSurface failed: %s", SDL_GetError());
+			break;
+		}
+		if (job.paths.size() == 6 && face->w != face->h) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Cubemap face is not square: %s", path.c_str());
+			SDL_DestroySurface(face);
+			break;
+		}
+		if (!result.faces.empty() && (face->w != result.faces.front()->w || face->h != result.faces.front()->h)) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Cubemap faces differ in size: %s", path.c_str());
+			SDL_DestroySurface(face);
+			break;
+		}
+		result.faces.push_back(face);
+	}
+	if (result.faces.size() != job.paths.size()) {
+		for (SDL_Surface *face : result.faces) {
+			SDL_DestroySurface(face);
+		}
+		result.faces.clear();
+	}
+	SDL_LockMutex(m_decoded_lock);
+	m_decoded.push_back(std::move(result));
+	SDL_UnlockMutex(m_decoded_lock);
+}
+
+bool TextureStreamer::makeRoom(SDL_GPUCommandBuffer *cmdbuf, const Uint64 &bytes) {
+	const ContextData ctx { Context::get()->data() };
+	while (m_resident + bytes > m_budget) {
+		// m_frame has already advanced for this frame, so anything drawn last frame is still in use.
+		// Full textures go first, the tails of evicted ones only when nothing else is left
+		Entry *oldest { nullptr }, *oldest_tail { nullptr };
+		for (Entry &entry : m_entries) {
+			if (entry.last_used + 1 >= m_frame) {
+				continue;
+			}
+			if (entry.state == State::Resident && (oldest == nullptr || entry.last_used < oldest->last_used)) {
+				oldest = &entry;
+			}
+			if (entry.tail != nullptr && (oldest_tail == nullptr || entry.last_used < oldest_tail->last_used)) {
+				oldest_tail = &entry;
+			}
+		}
+		if (oldest == nullptr) {
+			if (oldest_tail == nullptr) {
+				return false;
+			}
+			releaseTail(*oldest_tail);
+			continue;
+		}
+		keepTail(cmdbuf, *oldest);
+		// the release is deferred by SDL until in-flight command buffers are done with it
+		SDL_ReleaseGPUTexture(ctx.gpu, oldest->texture);
+		oldest->texture = nullptr;
+		oldest->state = State::Evicted;
+		m_resident -= oldest->bytes;
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Evicted GPUTexture:\n\t%s\n\tKept tail: %s", oldest->paths.front().c_str(), oldest->tail != nullptr ? "yes" : "no");
+	}
+	return true;
+}
+
+void TextureStreamer::keepTail(SDL_GPUCommandBuffer *cmdbuf, Entry &entry) {
+	const ContextData ctx { Context::get()->data() };
+	// the first level no larger than TAIL_SIZE, textures already that small aren't worth a copy
+	Uint32 first { };
+	while (SDL_max(entry.width >> first, entry.height >> first) > TAIL_SIZE) {
+		++first;
+	}
+	if (first == 0) {
+		return;
+	}
+	const Uint32 width { SDL_max(entry.width >> first, 1u) }, height { SDL_max(entry.height >> first, 1u) };
+	const Uint32 levels { MipCount(width, height) };
+	const SDL_GPUTextureCreateInfo tail_create {
+		.type = entry.type,
+		.format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM,
+		.usage = SDL_GPU_TEXTUREUSAGE_SAMPLER,
+		.width = width,
+		.height = height,
+		.layer_count_or_depth = entry.layers,
+		.num_levels = levels,
+		.sample_count = SDL_GPU_SAMPLECOUNT_1
+	};
+	entry.tail = SDL_CreateGPUTexture(ctx.gpu, &tail_create);
+	if (entry.tail == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateGPUTexture failed: %s", SDL_GetError());
+		return;
+	}
+	SDL_GPUCopyPass *copy_pass { SDL_BeginGPUCopyPass(cmdbuf) };
+	for (Uint32 level = 0; level < levels; ++level) {
+		for (Uint32 layer = 0; layer < entry.layers; ++layer) {
+			const SDL_GPUTextureLocation source { .texture = entry.texture, .mip_level = first + level, .layer = layer };
+			const SDL_GPUTextureLocation destination { .texture = entry.tail, .mip_level = level, .layer = layer };
+			SDL_CopyGPUTextureToTexture(copy_pass, &source, &destination, SDL_max(width >> level, 1u), SDL_max(height >> level, 1u), 1, false);
+		}
+	}
+	SDL_EndGPUCopyPass(copy_pass);
+	entry.tail_bytes = TextureBytes(width, height, entry.layers);
+	m_resident += entry.tail_bytes;
+}
+
+void TextureStreamer::releaseTail(Entry &entry) {
+	const ContextData ctx { Context::get()->data() };
+	SDL_ReleaseGPUTexture(ctx.gpu, entry.tail);
+	entry.tail = nullptr;
+	m_resident -= entry.tail_bytes;
+	entry.tail_bytes = 0;
+}
+
+void TextureStreamer::restoreLevels() {
+	// one level up is about 4x the bytes, only ask for it while it fits without evicting anything
+	for (TextureHandle handle = 0; handle < m_entries.size(); ++handle) {
+		Entry &entry { m_entries.at(handle) };
+		if (entry.state == State::Resident && entry.skip_levels > 0 && !entry.pending && m_resident + entry.bytes * 3 <= m_budget) {
+			--entry.skip_levels;
+			enqueue(handle);
+			return; // one a frame, so the decodes don't crowd out new requests
+		}
+	}
+}
+
+void TextureStreamer::update(SDL_GPUCommandBuffer *cmdbuf) {
+	const ContextData ctx { Context::get()->data() };
+	++m_frame;
+	restoreLevels();
+	// take as many decoded images as fit this frame's upload allowance (always at least one)
+	std::vector<Decoded> batch;
+	Uint64 batch_bytes { };
+	SDL_LockMutex(m_decoded_lock);
+	while (!m_decoded.empty()) {
+		const Decoded &next { m_decoded.front() };
+		const Uint64 bytes { next.faces.empty() ? 0 : static_cast<Uint64>(next.faces.front()->w) * next.faces.front()->h * BYTES_PER_PIXEL * next.faces.size() };
+		if (!batch.empty() && batch_bytes + bytes > m_upload_per_frame) {
+			break;
+		}
+		batch_bytes += bytes;
+		batch.push_back(std::move(m_decoded.front()));
+		m_decoded.pop_front();
+	}
+	SDL_UnlockMutex(m_decoded_lock);
+	if (batch.empty()) {
+		return;
+	}
+	// create the destination textures, evicting or downscaling to stay under budget
+	std::vector<Decoded*> uploads;
+	Uint32 upload_bytes { };
+	for (Decoded &decoded : batch) {
+		Entry &entry { m_entries.at(decoded.handle) };
+		entry.pending = false;
+		// a resident entry is being restored to more levels, it keeps its texture until the new one is made
+		const bool restoring { entry.state == State::Resident };
+		if (decoded.faces.empty()) {
+			if (restoring) {
+				++entry.skip_levels;
+			} else {
+				entry.state = State::Failed;
+			}
+			continue;
+		}
+		const Uint32 width { static_cast<Uint32>(decoded.faces.front()->w) };
+		const Uint32 height { static_cast<Uint32>(decoded.faces.front()->h) };
+		const Uint32 layers { static_cast<Uint32>(decoded.faces.size()) };
+		const Uint64 bytes { TextureBytes(width, height, layers) };
+		Uint64 needed { bytes };
+		if (restoring) {
+			entry.last_used = m_frame; // not evictable while it is being replaced
+			needed = bytes > entry.bytes ? bytes - entry.bytes : 0;
+		}
+		if (!makeRoom(cmdbuf, needed)) {
+			for (SDL_Surface *face : decoded.faces) {
+				SDL_DestroySurface(face);
+			}
+			decoded.faces.clear();
+			if (restoring) {
+				entry.skip_levels = decoded.skip_levels + 1;
+				continue;
+			}
+			if (width == 1 && height == 1) {
+				SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Texture does not fit budget:\n\t%s", entry.paths.front().c_str());
+				entry.state = State::Failed;
+				continue;
+			}
+			entry.skip_levels = decoded.skip_levels + 1;
+			enqueue(decoded.handle);
+			continue;
+		}
+		SDL_GPUTexture *replaced { restoring ? entry.texture : nullptr };
+		const SDL_GPUTextureCreateInfo texture_create {
+			.type = entry.type,
+			.format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM,
+			.usage = SDL_GPU_TEXTUREUSAGE_SAMPLER | SDL_GPU_TEXTUREUSAGE_COLOR_TARGET, // color target for mip generation
+			.width = width,
+			.height = height,
+			.layer_count_or_depth = layers,
+			.num_levels = MipCount(width, height),
+			.sample_count = SDL_GPU_SAMPLECOUNT_1
+		};
+		entry.texture = SDL_CreateGPUTexture(ctx.gpu, &texture_create);
+		if (entry.texture == nullptr) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateGPUTexture failed: %s", SDL_GetError());
+			for (SDL_Surface *face : decoded.faces) {
+				SDL_DestroySurface(face);
+			}
+			decoded.faces.clear();
+			if (restoring) {
+				entry.texture = replaced;
+				entry.skip_levels = decoded.skip_levels + 1;
+			} else {
+				entry.state = State::Failed;
+			}
+			continue;
+		}
+		if (replaced != nullptr) {
+			SDL_ReleaseGPUTexture(ctx.gpu, replaced);
+			m_resident -= entry.bytes;
+		}
+		// drawn from the placeholder state until the upload below lands
+		entry.state = State::Queued;
+		entry.bytes = bytes;
+		entry.width = width;
+		entry.height = height;
+		entry.layers = layers;
+		m_resident += bytes;
+		upload_bytes += width * height * BYTES_PER_PIXEL * layers;
+		uploads.push_back(&decoded);
+	}
+	if (uploads.empty()) {
+		return;
+	}
+	// stage every image of the batch in one transfer buffer and copy them in a single pass
+	const SDL_GPUTransferBufferCreateInfo trans_buff_info {
+		.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+		.size = upload_bytes
+	};
+	SDL_GPUTransferBuffer *transfer_buffer { SDL_CreateGPUTransferBuffer(ctx.gpu, &trans_buff_info) };
+	Uint8 *transfer_data { transfer_buffer == nullptr ? nullptr : static_cast<Uint8*>(SDL_MapGPUTransferBuffer(ctx.gpu, transfer_buffer, false)) };
+	if (transfer_data == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "MapGPUTransferBuffer failed: %s", SDL_GetError());
+		SDL_ReleaseGPUTransferBuffer(ctx.gpu, transfer_buffer);
+		for (Decoded *decoded : uploads) {
+			Entry &entry { m_entries.at(decoded->handle) };
+			SDL_ReleaseGPUTexture(ctx.gpu, entry.texture);
+			entry.texture = nullptr;
+			entry.state = State::Queued;
+			m_resident -= entry.bytes;
+			for (SDL_Surface *face : decoded->faces) {
+				SDL_DestroySurface(face);
+			}
+			decoded->faces.clear();
+			enqueue(decoded->handle);
+		}
+		return;
+	}
+	Uint32 offset { };
+	for (Decoded *decoded : uploads) {
+		for (SDL_Surface *face : decoded->faces) {
+			const Uint32 row_bytes { static_cast<Uint32>(face->w) * BYTES_PER_PIXEL };
+			for (int row = 0; row < face->h; ++row) {
+				SDL_memcpy(transfer_data + offset + row * row_bytes, static_cast<Uint8*>(face->pixels) + row * face->pitch, row_bytes);
+			}
+			offset += row_bytes * face->h;
+		}
+	}
+	SDL_UnmapGPUTransferBuffer(ctx.gpu, transfer_buffer);
+	offset = 0;
+	SDL_GPUCopyPass *copy_pass { SDL_BeginGPUCopyPass(cmdbuf) };
+	for (Decoded *decoded : uploads) {
+		Entry &entry { m_entries.at(decoded->handle) };
+		for (Uint32 layer = 0; layer < decoded->faces.size(); ++layer) {
+			SDL_Surface *face { decoded->faces.at(layer) };
+			const SDL_GPUTextureTransferInfo transfer_info {
+				.transfer_buffer = transfer_buffer,
+				.offset = offset,
+				.pixels_per_row = static_cast<Uint32>(face->w),
+				.rows_per_layer = static_cast<Uint32>(face->h)
+			};
+			const SDL_GPUTextureRegion region {
+				.texture = entry.texture,
+				.mip_level = 0,
+				.layer = layer,
+				.w = static_cast<Uint32>(face->w),
+				.h = static_cast<Uint32>(face->h),
+				.d = 1
+			};
+			SDL_UploadToGPUTexture(copy_pass, &transfer_info, &region, false);
+			offset += static_cast<Uint32>(face->w) * face->h * BYTES_PER_PIXEL;
+			SDL_DestroySurface(face);
+		}
+		decoded->faces.clear();
+	}
+	SDL_EndGPUCopyPass(copy_pass);
+	SDL_ReleaseGPUTransferBuffer(ctx.gpu, transfer_buffer);
+	for (Decoded *decoded : uploads) {
+		Entry &entry { m_entries.at(decoded->handle) };
+		SDL_GenerateMipmapsForGPUTexture(cmdbuf, entry.texture);
+		entry.state = State::Resident;
+		entry.last_used = m_frame;
+		if (entry.tail != nullptr) {
+			releaseTail(entry);
+		}
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Streamed GPUTexture:\n\t%s\n\tSkipped levels: %u", entry.paths.front().c_str(), decoded->skip_levels);
+	}
+}
+
+SDL_GPUTexture* TextureStreamer::get(const TextureHandle &handle) {
+	if (handle >= m_entries.size()) {
+		return nullptr;
+	}
+	Entry &entry { m_entries.at(handle) };
+	entry.last_used = m_frame;
+	if (entry.state == State::Resident) {
+		return entry.texture;
+	}
+	if (entry.state == State::Evicted) {
+		entry.state = State::Queued;
+		if (!entry.pending) {
+			enqueue(handle);
+		}
+	}
+	if (entry.tail != nullptr) {
+		return entry.tail;
+	}
+	return entry.type == SDL_GPU_TEXTURETYPE_CUBE ? m_fallback_cube : m_fallback_2d;
+}
+
+bool TextureStreamer::isResident(const TextureHandle &handle) const {
+	return handle < m_entries.size() && m_entries.at(handle).state == State::Resident;
+}
@@ -0,0 +1,82 @@
+#include "TransientBuffer.hpp"
+#include "SDL3/SDL_log.h"
+
+TransientBuffer::TransientBuffer(const SDL_GPUBufferUsageFlags &buffer_usage, const Uint32 &t_capacity_per_frame)
+	: m_capacity((t_capacity_per_frame + MAX_ALIGN - 1) / MAX_ALIGN * MAX_ALIGN) {
+	const ContextData ctx { Context::get()->data() };
+	const SDL_GPUBufferCreateInfo buff_info {
+		.usage = buffer_usage,
+		.size = m_capacity * FRAMES_IN_FLIGHT
+	};
+	m_buffer = SDL_CreateGPUBuffer(ctx.gpu, &buff_info);
+	if (m_buffer == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateGPUBuffer failed: %s", SDL_GetError());
+		return;
+	}
+	const SDL_GPUTransferBufferCreateInfo trans_buff_info {
+		.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+		.size = m_capacity
+	};
+	m_transfer_buffer = SDL_CreateGPUTransferBuffer(ctx.gpu, &trans_buff_info);
+	if (m_transfer_buffer == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateGPUTransferBuffer failed: %s", SDL_GetError());
+		return;
+	}
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Created TransientBuffer:\n\tPer frame: %u bytes\n\tFrames in flight: %u", m_capacity, FRAMES_IN_FLIGHT);
+}
+
+TransientBuffer::~TransientBuffer() {
+	const ContextData ctx { Context::get()->data() };
+	if (m_mapped != nullptr) {
+		SDL_UnmapGPUTransferBuffer(ctx.gpu, m_transfer_buffer);
+	}
+	SDL_ReleaseGPUTransferBuffer(ctx.gpu, m_transfer_buffer);
+	SDL_ReleaseGPUBuffer(ctx.gpu, m_buffer);
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Released TransientBuffer");
+}
+
+TransientAllocation TransientBuffer::allocate(const Uint32 &size, const Uint32 &align) {
+	if (align == 0 || MAX_ALIGN % align != 0) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "TransientBuffer can't align to %u bytes, only to divisors of %u", align, MAX_ALIGN);
+		return TransientAllocation { nullptr, 0 };
+	}
+	const Uint32 offset { (m_head + align - 1) / align * align };
+	if (m_transfer_buffer == nullptr || offset + size > m_capacity) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "TransientBuffer out of space:\n\tRequested: %u bytes\n\tUsed: %u of %u bytes", size, m_head, m_capacity);
+		return TransientAllocation { nullptr, 0 };
+	}
+	if (m_mapped == nullptr) {
+		// cycling hands back staging memory the GPU is no longer reading from
+		const ContextData ctx { Context::get()->data() };
+		m_mapped = static_cast<Uint8*>(SDL_MapGPUTransferBuffer(ctx.gpu, m_transfer_buffer, true));
+		if (m_mapped == nullptr) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "MapGPUTransferBuffer failed: %s", SDL_GetError());
+			return TransientAllocation { nullptr, 0 };
+		}
+	}
+	m_head = offset + size;
+	return TransientAllocation { m_mapped + offset, m_slot * m_capacity + offset };
+}
+
+void TransientBuffer::flush(SDL_GPUCommandBuffer *cmdbuf) {
+	if (m_mapped != nullptr) {
+		const ContextData ctx { Context::get()->data() };
+		SDL_UnmapGPUTransferBuffer(ctx.gpu, m_transfer_buffer);
+		m_mapped = nullptr;
+		SDL_GPUCopyPass *copy_pass { SDL_BeginGPUCopyPass(cmdbuf) };
+		const SDL_GPUTransferBufferLocation transfer_buffer_loc {
+			.transfer_buffer = m_transfer_buffer,
+			.offset = 0
+		};
+		const SDL_GPUBufferRegion buffer_region {
+			.buffer = m_buffer,
+			.offset = m_slot * m_capacity,
+			.size = m_head
+		};
+		SDL_UploadToGPUBuffer(copy_pass, &transfer_buffer_loc, &buffer_region, false);
+		SDL_EndGPUCopyPass(copy_pass);
+	}
+	// the next frame writes the next slice
+	m_slot = (m_slot + 1) % FRAMES_IN_FLIGHT;
+	m_head = 0;
+}
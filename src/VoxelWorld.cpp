@@ -0,0 +1,495 @@
+#include <algorithm>
+
+#include "VoxelWorld.hpp"
+#include "SDL3/SDL_log.h"
+#include "SDL3/SDL_timer.h"
+
+namespace {
+	enum Block : Uint8 { AIR, GRASS, DIRT, STONE };
+
+	constexpr Uint8 BLOCK_COLORS[4][3] {
+		{ 0, 0, 0 },
+		{ 106, 170, 64 },
+		{ 134, 96, 67 },
+		{ 125, 125, 125 }
+	};
+
+	// baked directional shading, indexed by axis * 2 + positive side
+	constexpr float FACE_SHADE[6] { 0.8f, 0.8f, 0.5f, 1.0f, 0.65f, 0.65f };
+
+	Uint8 GenerateBlock(const int &x, const int &y, const int &z) {
+		if (y < 0) {
+			return STONE; // solid below the world so its underside is never meshed
+		}
+		const float fx { static_cast<float>(x) }, fz { static_cast<float>(z) };
+		const int height { 20 + static_cast<int>(6.0f * SDL_sinf(fx * 0.11f) + 5.0f * SDL_cosf(fz * 0.09f) + 3.0f * SDL_sinf((fx + fz) * 0.05f)) };
+		if (y > height) {
+			return AIR;
+		} else if (y == height) {
+			return GRASS;
+		} else if (y > height - 4) {
+			return DIRT;
+		}
+		return STONE;
+	}
+
+	int FloorDiv(const float &value, const int &size) {
+		return static_cast<int>(SDL_floorf(value / static_cast<float>(size)));
+	}
+}
+
+VoxelWorld::VoxelWorld(const int &t_load_radius, const Uint32 &t_upload_per_frame, const int &t_worker_count)
+	: m_quad_indices(SDL_GPU_BUFFERUSAGE_INDEX, MAX_QUADS * 6),
+	// stream() keeps chunks up to one past the load radius
+	m_instances(SDL_GPU_BUFFERUSAGE_VERTEX, sizeof(VoxelInstance) * (2 * t_load_radius + 3) * (2 * t_load_radius + 3) * HEIGHT_CHUNKS),
+	m_load_radius(t_load_radius), m_upload_per_frame(t_upload_per_frame) {
+	Uint32 *indices { m_quad_indices.open() };
+	if (indices != nullptr) {
+		for (Uint32 quad = 0; quad < MAX_QUADS; ++quad) {
+			const Uint32 base { quad * 4 };
+			indices[quad * 6 + 0] = base + 0;
+			indices[quad * 6 + 1] = base + 1;
+			indices[quad * 6 + 2] = base + 2;
+			indices[quad * 6 + 3] = base + 0;
+			indices[quad * 6 + 4] = base + 2;
+			indices[quad * 6 + 5] = base + 3;
+		}
+		m_quad_indices.upload();
+	}
+	m_jobs_lock = SDL_CreateMutex();
+	m_jobs_cond = SDL_CreateCondition();
+	m_results_lock = SDL_CreateMutex();
+	if (m_jobs_lock == nullptr || m_jobs_cond == nullptr || m_results_lock == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateMutex failed: %s", SDL_GetError());
+		return;
+	}
+	for (int i = 0; i < t_worker_count; ++i) {
+		SDL_Thread *thread { SDL_CreateThread(worker, "VoxelMesher", this) };
+		if (thread == nullptr) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateThread failed: %s", SDL_GetError());
+			continue;
+		}
+		m_workers.push_back(thread);
+	}
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Created VoxelWorld:\n\tLoad radius: %d chunks\n\tWorkers: %zu", m_load_radius, m_workers.size());
+}
+
+VoxelWorld::~VoxelWorld() {
+	const ContextData ctx { Context::get()->data() };
+	SDL_SetAtomicInt(&m_quit, 1);
+	SDL_LockMutex(m_jobs_lock);
+	SDL_BroadcastCondition(m_jobs_cond);
+	SDL_UnlockMutex(m_jobs_lock);
+	for (SDL_Thread *thread : m_workers) {
+		SDL_WaitThread(thread, NULL);
+	}
+	for (auto &[chunk_key, chunk] : m_chunks) {
+		SDL_ReleaseGPUBuffer(ctx.gpu, chunk.vertices);
+	}
+	SDL_DestroyMutex(m_results_lock);
+	SDL_DestroyCondition(m_jobs_cond);
+	SDL_DestroyMutex(m_jobs_lock);
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Released VoxelWorld");
+}
+
+Uint64 VoxelWorld::key(const std::array<int, 3> &coord) {
+	// 21 bits per axis
+	return (static_cast<Uint64>(coord.at(0) & 0x1FFFFF) << 42) | (static_cast<Uint64>(coord.at(1) & 0x1FFFFF) << 21) | static_cast<Uint64>(coord.at(2) & 0x1FFFFF);
+}
+
+int VoxelWorld::index(const int &x, const int &y, const int &z) {
+	return ((z + 1) * PADDED_SIZE + (y + 1)) * PADDED_SIZE + (x + 1);
+}
+
+void VoxelWorld::generate(const std::array<int, 3> &coord, Volume &volume) {
+	const int base_x { coord.at(0) * CHUNK_SIZE }, base_y { coord.at(1) * CHUNK_SIZE }, base_z { coord.at(2) * CHUNK_SIZE };
+	for (int z = -1; z <= CHUNK_SIZE; ++z) {
+		for (int y = -1; y <= CHUNK_SIZE; ++y) {
+			for (int x = -1; x <= CHUNK_SIZE; ++x) {
+				volume[index(x, y, z)] = GenerateBlock(base_x + x, base_y + y, base_z + z);
+			}
+		}
+	}
+}
+
+void VoxelWorld::mesh(const Volume &volume, std::vector<VoxelVertex> &vertices) {
+	std::array<Uint8, CHUNK_SIZE * CHUNK_SIZE> mask;
+	for (int d = 0; d < 3; ++d) {
+		const int u { (d + 1) % 3 }, v { (d + 2) % 3 };
+		for (int side = 0; side < 2; ++side) {
+			const int step { side == 0 ? -1 : 1 };
+			const float shade { FACE_SHADE[d * 2 + side] };
+			for (int slice = 0; slice < CHUNK_SIZE; ++slice) {
+				// faces of this slice that look into air
+				for (int j = 0; j < CHUNK_SIZE; ++j) {
+					for (int i = 0; i < CHUNK_SIZE; ++i) {
+						int pos[3];
+						pos[d] = slice;
+						pos[u] = i;
+						pos[v] = j;
+						const Uint8 block { volume[index(pos[0], pos[1], pos[2])] };
+						pos[d] += step;
+						const Uint8 neighbour { volume[index(pos[0], pos[1], pos[2])] };
+						mask[j * CHUNK_SIZE + i] = neighbour == AIR ? block : AIR;
+					}
+				}
+				// grow each face along u, then along v while the whole row matches
+				for (int j = 0; j < CHUNK_SIZE; ++j) {
+					for (int i = 0; i < CHUNK_SIZE;) {
+						const Uint8 block { mask[j * CHUNK_SIZE + i] };
+						if (block == AIR) {
+							++i;
+							continue;
+						}
+						int w { 1 };
+						while (i + w < CHUNK_SIZE && mask[j * CHUNK_SIZE + i + w] == block) {
+							++w;
+						}
+						int h { 1 };
+						while (j + h < CHUNK_SIZE) {
+							int k { 0 };
+							while (k < w && mask[(j + h) * CHUNK_SIZE + i + k] == block) {
+								++k;
+							}
+							if (k < w) {
+								break;
+							}
+							++h;
+						}
+						for (int l = 0; l < h; ++l) {
+							SDL_memset(&mask[(j + l) * CHUNK_SIZE + i], AIR, w);
+						}
+						int corner[3];
+						corner[d] = slice + side;
+						corner[u] = i;
+						corner[v] = j;
+						int du[3] { }, dv[3] { };
+						du[u] = w;
+						dv[v] = h;
+						const Uint8 r { static_cast<Uint8>(BLOCK_COLORS[block][0] * shade) };
+						const Uint8 g { static_cast<Uint8>(BLOCK_COLORS[block][1] * shade) };
+						const Uint8 b { static_cast<Uint8>(BLOCK_COLORS[block][2] * shade) };
+						auto vertex = [&](const int &a, const int &c) -> VoxelVertex {
+							return VoxelVertex {
+								static_cast<Uint8>(corner[0] + du[0] * a + dv[0] * c),
+								static_cast<Uint8>(corner[1] + du[1] * a + dv[1] * c),
+								static_cast<Uint8>(corner[2] + du[2] * a + dv[2] * c),
+								static_cast<Uint8>(d * 2 + side),
+								r, g, b, 255
+							};
+						};
+						// counter clockwise seen from the side the face points to
+						if (side == 1) {
+							vertices.push_back(vertex(0, 0));
+							vertices.push_back(vertex(1, 0));
+							vertices.push_back(vertex(1, 1));
+							vertices.push_back(vertex(0, 1));
+						} else {
+							vertices.push_back(vertex(0, 0));
+							vertices.push_back(vertex(0, 1));
+							vertices.push_back(vertex(1, 1));
+							vertices.push_back(vertex(1, 0));
+						}
+						i += w;
+					}
+				}
+			}
+		}
+	}
+}
+
+int VoxelWorld::worker(void *data) {
+	VoxelWorld *self { static_cast<VoxelWorld*>(data) };
+	while (true) {
+		SDL_LockMutex(self->m_jobs_lock);
+		while (self->m_jobs.empty() && SDL_GetAtomicInt(&self->m_quit) == 0) {
+			SDL_WaitCondition(self->m_jobs_cond, self->m_jobs_lock);
+		}
+		if (SDL_GetAtomicInt(&self->m_quit) != 0) {
+			SDL_UnlockMutex(self->m_jobs_lock);
+			return 0;
+		}
+		Job job { std::move(self->m_jobs.front()) };
+		self->m_jobs.pop_front();
+		SDL_UnlockMutex(self->m_jobs_lock);
+
+		const Uint64 start_ns { SDL_GetTicksNS() };
+		if (job.volume == nullptr) {
+			job.volume = std::make_unique<Volume>();
+			generate(job.coord, *job.volume);
+		}
+		Result result { job.coord, job.incarnation, job.version, std::move(job.volume), {}, 0 };
+		mesh(*result.volume, result.vertices);
+		result.mesh_ns = SDL_GetTicksNS() - start_ns;
+		SDL_LockMutex(self->m_results_lock);
+		self->m_results.push_back(std::move(result));
+		SDL_UnlockMutex(self->m_results_lock);
+	}
+}
+
+void VoxelWorld::enqueue(Chunk &chunk) {
+	Job job { chunk.coord, chunk.incarnation, chunk.version, nullptr };
+	if (chunk.volume != nullptr) {
+		// workers mesh a snapshot so edits can keep landing meanwhile
+		job.volume = std::make_unique<Volume>(*chunk.volume);
+	}
+	chunk.in_flight = true;
+	SDL_LockMutex(m_jobs_lock);
+	m_jobs.push_back(std::move(job));
+	SDL_SignalCondition(m_jobs_cond);
+	SDL_UnlockMutex(m_jobs_lock);
+}
+
+bool VoxelWorld::setBlock(const int &x, const int &y, const int &z, const Uint8 &block) {
+	// the voxel also lives in the padding of up to 7 neighbouring chunks
+	bool found { false };
+	const int cx { FloorDiv(static_cast<float>(x), CHUNK_SIZE) }, cy { FloorDiv(static_cast<float>(y), CHUNK_SIZE) }, cz { FloorDiv(static_cast<float>(z), CHUNK_SIZE) };
+	for (int oz = -1; oz <= 1; ++oz) {
+		for (int oy = -1; oy <= 1; ++oy) {
+			for (int ox = -1; ox <= 1; ++ox) {
+				auto it { m_chunks.find(key({ cx + ox, cy + oy, cz + oz })) };
+				if (it == m_chunks.end() || it->second.volume == nullptr) {
+					continue;
+				}
+				Chunk &chunk { it->second };
+				const int lx { x - chunk.coord.at(0) * CHUNK_SIZE }, ly { y - chunk.coord.at(1) * CHUNK_SIZE }, lz { z - chunk.coord.at(2) * CHUNK_SIZE };
+				if (lx < -1 || lx > CHUNK_SIZE || ly < -1 || ly > CHUNK_SIZE || lz < -1 || lz > CHUNK_SIZE) {
+					continue;
+				}
+				(*chunk.volume)[index(lx, ly, lz)] = block;
+				chunk.version = ++m_next_version;
+				found = true;
+			}
+		}
+	}
+	return found;
+}
+
+void VoxelWorld::stream(const Vector3 &camera_pos) {
+	const ContextData ctx { Context::get()->data() };
+	const int cx { FloorDiv(camera_pos.at(0) - m_origin.at(0), CHUNK_SIZE) };
+	const int cz { FloorDiv(camera_pos.at(2) - m_origin.at(2), CHUNK_SIZE) };
+	// unload one chunk past the load radius so the border doesn't thrash
+	for (auto it = m_chunks.begin(); it != m_chunks.end();) {
+		const Chunk &chunk { it->second };
+		if (SDL_abs(chunk.coord.at(0) - cx) > m_load_radius + 1 || SDL_abs(chunk.coord.at(2) - cz) > m_load_radius + 1) {
+			m_stats.quads -= chunk.quad_count;
+			SDL_ReleaseGPUBuffer(ctx.gpu, chunk.vertices);
+			it = m_chunks.erase(it);
+		} else {
+			++it;
+		}
+	}
+	// load missing chunks nearest first
+	std::vector<std::array<int, 3>> missing;
+	for (int z = cz - m_load_radius; z <= cz + m_load_radius; ++z) {
+		for (int x = cx - m_load_radius; x <= cx + m_load_radius; ++x) {
+			for (int y = 0; y < HEIGHT_CHUNKS; ++y) {
+				if (!m_chunks.contains(key({ x, y, z }))) {
+					missing.push_back({ x, y, z });
+				}
+			}
+		}
+	}
+	std::sort(missing.begin(), missing.end(), [cx, cz](const std::array<int, 3> &a, const std::array<int, 3> &b) {
+		return (a.at(0) - cx) * (a.at(0) - cx) + (a.at(2) - cz) * (a.at(2) - cz) < (b.at(0) - cx) * (b.at(0) - cx) + (b.at(2) - cz) * (b.at(2) - cz);
+	});
+	for (const std::array<int, 3> &coord : missing) {
+		Chunk &chunk { m_chunks[key(coord)] };
+		chunk.coord = coord;
+		chunk.version = ++m_next_version;
+		chunk.incarnation = chunk.version;
+		enqueue(chunk);
+	}
+	// remesh edited chunks
+	for (auto &[chunk_key, chunk] : m_chunks) {
+		if (!chunk.in_flight && chunk.volume != nullptr && chunk.version != chunk.meshed_version) {
+			enqueue(chunk);
+		}
+	}
+}
+
+void VoxelWorld::upload(SDL_GPUCommandBuffer *cmdbuf) {
+	const ContextData ctx { Context::get()->data() };
+	// take finished meshes up to this frame's upload allowance (always at least one)
+	std::vector<Result> batch;
+	Uint32 batch_bytes { };
+	SDL_LockMutex(m_results_lock);
+	while (!m_results.empty()) {
+		const Uint32 bytes { static_cast<Uint32>(m_results.front().vertices.size() * sizeof(VoxelVertex)) };
+		if (!batch.empty() && batch_bytes + bytes > m_upload_per_frame) {
+			break;
+		}
+		batch_bytes += bytes;
+		batch.push_back(std::move(m_results.front()));
+		m_results.pop_front();
+	}
+	SDL_UnlockMutex(m_results_lock);
+
+	std::vector<std::pair<Chunk*, const Result*>> uploads;
+	Uint32 upload_bytes { };
+	for (Result &result : batch) {
+		++m_stats.meshes;
+		m_stats.mesh_ns += result.mesh_ns;
+		auto it { m_chunks.find(key(result.coord)) };
+		if (it == m_chunks.end() || it->second.incarnation != result.incarnation) {
+			continue; // unloaded while meshing, a reloaded chunk waits for its own job
+		}
+		Chunk &chunk { it->second };
+		chunk.in_flight = false;
+		if (chunk.volume == nullptr) {
+			chunk.volume = std::move(result.volume);
+		}
+		if (result.version != chunk.version) {
+			continue; // edited while meshing, stream() queues it again
+		}
+		chunk.meshed_version = result.version;
+		m_stats.quads -= chunk.quad_count;
+		SDL_ReleaseGPUBuffer(ctx.gpu, chunk.vertices);
+		chunk.vertices = nullptr;
+		chunk.quad_count = static_cast<Uint32>(result.vertices.size() / 4);
+		m_stats.quads += chunk.quad_count;
+		if (chunk.quad_count == 0) {
+			continue;
+		}
+		const SDL_GPUBufferCreateInfo buff_info {
+			.usage = SDL_GPU_BUFFERUSAGE_VERTEX,
+			.size = static_cast<Uint32>(result.vertices.size() * sizeof(VoxelVertex))
+		};
+		chunk.vertices = SDL_CreateGPUBuffer(ctx.gpu, &buff_info);
+		if (chunk.vertices == nullptr) {
+			SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "CreateGPUBuffer failed: %s", SDL_GetError());
+			m_stats.quads -= chunk.quad_count;
+			chunk.quad_count = 0;
+			continue;
+		}
+		upload_bytes += buff_info.size;
+		uploads.push_back({ &chunk, &result });
+	}
+	if (uploads.empty()) {
+		return;
+	}
+	// one staging buffer and one copy pass for every mesh of the batch
+	const SDL_GPUTransferBufferCreateInfo trans_buff_info {
+		.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
+		.size = upload_bytes
+	};
+	SDL_GPUTransferBuffer *transfer_buffer { SDL_CreateGPUTransferBuffer(ctx.gpu, &trans_buff_info) };
+	Uint8 *transfer_data { transfer_buffer == nullptr ? nullptr : static_cast<Uint8*>(SDL_MapGPUTransferBuffer(ctx.gpu, transfer_buffer, false)) };
+	if (transfer_data == nullptr) {
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "MapGPUTransferBuffer failed: %s", SDL_GetError());
+		SDL_ReleaseGPUTransferBuffer(ctx.gpu, transfer_buffer);
+		for (auto &[chunk, result] : uploads) {
+			// drop the empty buffers and mesh again next frame
+			m_stats.quads -= chunk->quad_count;
+			SDL_ReleaseGPUBuffer(ctx.gpu, chunk->vertices);
+			chunk->vertices = nullptr;
+			chunk->quad_count = 0;
+			chunk->meshed_version = 0;
+		}
+		return;
+	}
+	Uint32 offset { };
+	for (auto &[chunk, result] : uploads) {
+		const Uint32 size { static_cast<Uint32>(result->vertices.size() * sizeof(VoxelVertex)) };
+		SDL_memcpy(transfer_data + offset, result->vertices.data(), size);
+		offset += size;
+	}
+	SDL_UnmapGPUTransferBuffer(ctx.gpu, transfer_buffer);
+	offset = 0;
+	SDL_GPUCopyPass *copy_pass { SDL_BeginGPUCopyPass(cmdbuf) };
+	for (auto &[chunk, result] : uploads) {
+		const Uint32 size { static_cast<Uint32>(result->vertices.size() * sizeof(VoxelVertex)) };
+		const SDL_GPUTransferBufferLocation transfer_buffer_loc {
+			.transfer_buffer = transfer_buffer,
+			.offset = offset
+		};
+		const SDL_GPUBufferRegion buffer_region {
+			.buffer = chunk->vertices,
+			.offset = 0,
+			.size = size
+		};
+		SDL_UploadToGPUBuffer(copy_pass, &transfer_buffer_loc, &buffer_region, false);
+		offset += size;
+	}
+	SDL_EndGPUCopyPass(copy_pass);
+	SDL_ReleaseGPUTransferBuffer(ctx.gpu, transfer_buffer);
+	m_stats.uploads += uploads.size();
+	m_stats.uploaded_bytes += upload_bytes;
+}
+
+void VoxelWorld::report() {
+	const Uint64 now_ns { SDL_GetTicksNS() };
+	if (m_report_ns == 0) {
+		m_report_ns = now_ns;
+		return;
+	}
+	const Uint64 elapsed_ns { now_ns - m_report_ns };
+	if (elapsed_ns < 2000 * SDL_NS_PER_MS) {
+		return;
+	}
+	const double seconds { elapsed_ns / 1e9 };
+	const Uint64 meshes { m_stats.meshes - m_reported_meshes };
+	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "VoxelWorld:\n\tChunks: %zu\n\tQuads: %llu\n\tRemeshing: %.1f chunks/s (avg %.2f ms)\n\tUpload: %.2f MB/s",
+		m_chunks.size(),
+		static_cast<unsigned long long>(m_stats.quads),
+		meshes / seconds,
+		m_stats.meshes == 0 ? 0.0 : m_stats.mesh_ns / 1e6 / m_stats.meshes,
+		(m_stats.uploaded_bytes - m_reported_bytes) / seconds / (1024.0 * 1024.0));
+	m_report_ns = now_ns;
+	m_reported_meshes = m_stats.meshes;
+	m_reported_bytes = m_stats.uploaded_bytes;
+}
+
+void VoxelWorld::update(SDL_GPUCommandBuffer *cmdbuf, const Vector3 &camera_pos) {
+	upload(cmdbuf);
+	stream(camera_pos);
+	report();
+}
+
+void VoxelWorld::cull(SDL_GPUCommandBuffer *cmdbuf, HiZBuffer &hiz) {
+	for (auto &[chunk_key, chunk] : m_chunks) {
+		if (chunk.quad_count == 0) {
+			continue;
+		}
+		const Vector3 box_min {
+			m_origin.at(0) + chunk.coord.at(0) * CHUNK_SIZE,
+			m_origin.at(1) + chunk.coord.at(1) * CHUNK_SIZE,
+			m_origin.at(2) + chunk.coord.at(2) * CHUNK_SIZE
+		};
+		const Vector3 box_max { box_min.at(0) + CHUNK_SIZE, box_min.at(1) + CHUNK_SIZE, box_min.at(2) + CHUNK_SIZE };
+		chunk.visible = !hiz.occluded(box_min, box_max);
+		if (!chunk.visible) {
+			continue;
+		}
+		const TransientAllocation instance { m_instances.allocate(sizeof(VoxelInstance)) };
+		if (instance.data == nullptr) {
+			chunk.visible = false;
+			continue;
+		}
+		const VoxelInstance data { { box_min.at(0), box_min.at(1), box_min.at(2), 0 } };
+		SDL_memcpy(instance.data, &data, sizeof(data));
+		chunk.instance_offset = instance.offset;
+	}
+	// both the pre-pass & the lit pass draw from this frame's slice
+	m_instances.flush(cmdbuf);
+}
+
+void VoxelWorld::draw(SDL_GPURenderPass *render_pass, SDL_GPUCommandBuffer *cmdbuf, const Matrix4x4 &view_proj) {
+	const SDL_GPUBufferBinding index_binding { m_quad_indices.get(), 0 };
+	SDL_BindGPUIndexBuffer(render_pass, &index_binding, SDL_GPU_INDEXELEMENTSIZE_32BIT);
+	// one push per pass, the chunk origins come from m_instances
+	const VoxelUniforms uniforms { view_proj };
+	SDL_PushGPUVertexUniformData(cmdbuf, 0, &uniforms, sizeof(uniforms));
+	for (const auto &[chunk_key, chunk] : m_chunks) {
+		if (chunk.quad_count == 0 || !chunk.visible) {
+			continue;
+		}
+		const SDL_GPUBufferBinding vertex_bindings[2] {
+			{ chunk.vertices, 0 },
+			{ m_instances.get(), chunk.instance_offset }
+		};
+		SDL_BindGPUVertexBuffers(render_pass, 0, vertex_bindings, 2);
+		SDL_DrawGPUIndexedPrimitives(render_pass, chunk.quad_count * 6, 1, 0, 0, 0);
+	}
+}
@@ -3,11 +3,48 @@
 
 Context* Context::self = 0;
 
-int main() {
+// Renders every light count from 1 to MAX_LIGHTS, waiting on the GPU each frame, and logs the frame time.
+static void RunLightBenchmark(SceneMaterial &mat) {
+	const ContextData ctx { Context::get()->data() };
+	// don't let vsync hide the cost
+	if (SDL_WindowSupportsGPUPresentMode(ctx.gpu, ctx.window, SDL_GPU_PRESENTMODE_IMMEDIATE)) {
+		SDL_SetGPUSwapchainParameters(ctx.gpu, ctx.window, SDL_GPU_SWAPCHAINCOMPOSITION_SDR, SDL_GPU_PRESENTMODE_IMMEDIATE);
+	} else if (SDL_WindowSupportsGPUPresentMode(ctx.gpu, ctx.window, SDL_GPU_PRESENTMODE_MAILBOX)) {
+		SDL_SetGPUSwapchainParameters(ctx.gpu, ctx.window, SDL_GPU_SWAPCHAINCOMPOSITION_SDR, SDL_GPU_PRESENTMODE_MAILBOX);
+	}
+	const int warm_up_frames { 300 }, frames_per_step { 120 };
+	// let the voxel world finish streaming in first
+	for (int i = 0; i < warm_up_frames; ++i) {
+		SDL_PumpEvents();
+		mat.draw();
+	}
+	for (Uint32 count = 1; count <= ClusteredLighting::MAX_LIGHTS; count *= 4) {
+		mat.lighting()->scatterLights(count, 1);
+		mat.draw();
+		mat.finish();
+		const Uint64 start { SDL_GetPerformanceCounter() };
+		for (int i = 0; i < frames_per_step; ++i) {
+			SDL_PumpEvents();
+			mat.draw();
+			mat.finish();
+		}
+		const double frame_ms { (SDL_GetPerformanceCounter() - start) * 1000.0 / SDL_GetPerformanceFrequency() / frames_per_step };
+		// the last frame is finished, so its cull's overflow is readable
+		const ClusterOverflow overflow { mat.lighting()->overflow() };
+		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Light benchmark: %4u lights, %.3f ms/frame, %u clusters over the cap, %u lights dropped", count, frame_ms, overflow.clusters, overflow.lights);
+	}
+}
+
+int main(int argc, char *argv[]) {
 
 	Renderer renderer {1920, 1080};
 	SceneMaterial mat {};
 
+	if (argc > 1 && SDL_strcmp(argv[1], "--light-benchmark") == 0) {
+		RunLightBenchmark(mat);
+		return 0;
+	}
+
 	// main loop
 	float last_time { };
 	bool quit = false;
@@ -25,7 +62,18 @@ int main() {
 					quit = true;
 					break;
 				case SDLK_R:
-					/*mat.refresh();*/
+					mat.refresh();
+					break;
+				case SDLK_L: {
+					// 1, 4, 16 ... MAX_LIGHTS point lights
+					const Uint32 count { mat.lighting()->lightCount() * 4 };
+					mat.lighting()->scatterLights(count > ClusteredLighting::MAX_LIGHTS ? 1 : count, 1);
+					SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Point lights: %u", mat.lighting()->lightCount());
+					break;
+				}
+				case SDLK_P:
+					mat.setDepthPrepass(!mat.depthPrepass());
+					SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "Depth pre-pass: %s", mat.depthPrepass() ? "on" : "off");
 					break;
 				case SDLK_W: {
 					ctx.camera_pos.at(2) += 5;
@@ -0,0 +1,120 @@
+// Steady-state FrameArena frames must not touch the heap. Every global operator new/delete
+// and every SDL allocation (SDL_aligned_alloc goes through SDL_malloc) is counted.
+#include <cstdlib>
+#include <new>
+#include <SDL3/SDL_log.h>
+#include <SDL3/SDL_stdinc.h>
+
+#include "FrameArena.hpp"
+
+namespace {
+	bool g_counting { false };
+	Uint64 g_allocations { };
+	SDL_malloc_func g_malloc;
+	SDL_calloc_func g_calloc;
+	SDL_realloc_func g_realloc;
+	SDL_free_func g_free;
+
+	void Count() {
+		if (g_counting) {
+			++g_allocations;
+		}
+	}
+	void* SDLCALL CountingMalloc(size_t size) {
+		Count();
+		return g_malloc(size);
+	}
+	void* SDLCALL CountingCalloc(size_t count, size_t size) {
+		Count();
+		return g_calloc(count, size);
+	}
+	void* SDLCALL CountingRealloc(void *mem, size_t size) {
+		Count();
+		return g_realloc(mem, size);
+	}
+	void* CountedNew(const size_t &size) {
+		Count();
+		void *result { std::malloc(size == 0 ? 1 : size) };
+		if (result == nullptr) {
+			throw std::bad_alloc {};
+		}
+		return result;
+	}
+	// SDL_aligned_alloc is counted by CountingMalloc, & unlike std::aligned_alloc it exists on MSVC
+	void* CountedAlignedNew(const size_t &size, const std::align_val_t &align) {
+		void *result { SDL_aligned_alloc(static_cast<size_t>(align), size == 0 ? 1 : size) };
+		if (result == nullptr) {
+			throw std::bad_alloc {};
+		}
+		return result;
+	}
+
+	// what a frame's systems pull from the arena: per-frame uniforms, draw lists, scratch
+	struct Uniforms {
+		float view_proj[16];
+		float near_far[2];
+	};
+	struct DrawItem {
+		Uint32 first, count;
+		float origin[4];
+	};
+
+	constexpr size_t CAPACITY { 4096 };
+	constexpr int THREADS { 4 };
+	constexpr int FRAMES { 1000 };
+
+	bool Frame(FrameArena &arena) {
+		for (int i = 0; i < THREADS; ++i) {
+			LinearArena &local { arena.local(i) };
+			// several times the initial capacity, so the warm-up frame overflows
+			if (local.create<Uniforms>() == nullptr || local.create<DrawItem>(256) == nullptr || local.create<Uint8>(3 * CAPACITY) == nullptr) {
+				return false;
+			}
+		}
+		arena.reset();
+		return true;
+	}
+}
+
+void* operator new(size_t size) { return CountedNew(size); }
+void* operator new[](size_t size) { return CountedNew(size); }
+void* operator new(size_t size, std::align_val_t align) { return CountedAlignedNew(size, align); }
+void* operator new[](size_t size, std::align_val_t align) { return CountedAlignedNew(size, align); }
+void operator delete(void *mem) noexcept { std::free(mem); }
+void operator delete[](void *mem) noexcept { std::free(mem); }
+void operator delete(void *mem, size_t) noexcept { std::free(mem); }
+void operator delete[](void *mem, size_t) noexcept { std::free(mem); }
+void operator delete(void *mem, std::align_val_t) noexcept { SDL_aligned_free(mem); }
+void operator delete[](void *mem, std::align_val_t) noexcept { SDL_aligned_free(mem); }
+void operator delete(void *mem, size_t, std::align_val_t) noexcept { SDL_aligned_free(mem); }
+void operator delete[](void *mem, size_t, std::align_val_t) noexcept { SDL_aligned_free(mem); }
+
+int main() {
+	SDL_GetOriginalMemoryFunctions(&g_malloc, &g_calloc, &g_realloc, &g_free);
+	SDL_SetMemoryFunctions(CountingMalloc, CountingCalloc, CountingRealloc, g_free);
+
+	FrameArena arena { CAPACITY };
+	// warm-up: every slot overflows, reset() folds the overflow into one block
+	g_counting = true;
+	const bool warmed_up { Frame(arena) };
+	g_counting = false;
+	if (!warmed_up || g_allocations == 0) {
+		SDL_LogError(SDL_LOG_CATEGORY_TEST, "Warm-up frame didn't overflow, the counter isn't seeing the arena");
+		return EXIT_FAILURE;
+	}
+	SDL_LogInfo(SDL_LOG_CATEGORY_TEST, "Warm-up: %llu heap allocations", static_cast<unsigned long long>(g_allocations));
+
+	g_allocations = 0;
+	g_counting = true;
+	bool ok { true };
+	for (int frame = 0; ok && frame < FRAMES; ++frame) {
+		ok = Frame(arena);
+	}
+	g_counting = false;
+	if (!ok || g_allocations != 0) {
+		SDL_LogError(SDL_LOG_CATEGORY_TEST, "Steady state hit the heap:\n\tFrames: %d\n\tAllocations: %llu", FRAMES, static_cast<unsigned long long>(g_allocations));
+		return EXIT_FAILURE;
+	}
+	SDL_LogInfo(SDL_LOG_CATEGORY_TEST, "Steady state: 0 heap allocations over %d frames", FRAMES);
+	return EXIT_SUCCESS;
+}